@@ -0,0 +1,134 @@
+/*MIT License
+ *
+Copyright(c) 2022 Toni Pacheco
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+//! Microbenchmark harness. Each repetition runs an untimed setup and then the timed call; the
+//! warmup repetitions are discarded and the others are summarized by percentiles.
+class Bench {
+  public:
+    //! Bench constructor.
+    //! \param warmup: repetitions run before measuring.
+    //! \param repetitions: measured repetitions of every benchmark.
+    Bench(int warmup, int repetitions) : warmup(warmup), repetitions(repetitions), sink(0) {
+    }
+
+    //! Measure a call.
+    //! \param instance: instance file of the benchmark.
+    //! \param name: name of the measured call.
+    //! \param input: kind of input (e.g. random or educated solutions).
+    //! \param setup: untimed preparation of repetition r, returning false to skip it.
+    //! \param run: timed call, returning a value added to the checksum so that it is not optimized out
+    //! (values of 1e15 or more, such as DBL_MAX for no move found, are ignored).
+    template <typename Setup, typename Run>
+    void Measure(const std::string& instance, const std::string& name, const std::string& input, Setup setup,
+                 Run run) {
+      std::vector<double> samples;
+      int done = 0;
+
+      // a skipped repetition is retried with the next index, up to a bounded number of attempts
+      for (int r = 0; done < warmup + repetitions && r < 4 * (warmup + repetitions); r++) {
+        if (!setup(r)) continue;
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        double value = run();
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+        if (value < 1e15) sink += value;
+
+        if (done++ >= warmup) samples.push_back(std::chrono::duration<double, std::nano>(end - start).count());
+      }
+
+      if (samples.empty()) {
+        std::cerr << instance << " " << name << " (" << input << "): skipped, no repetition was set up" << std::endl;
+        return;
+      }
+
+      Result result;
+      result.instance = instance;
+      result.name = name;
+      result.input = input;
+      result.samples = samples;
+      std::sort(result.samples.begin(), result.samples.end());
+      results.push_back(result);
+
+      std::cerr << instance << " " << name << " (" << input << "): " << samples.size() << " samples, p50 "
+                << Percentile(result.samples, 50) << " ns" << std::endl;
+    }
+
+    //! Print every result as JSON.
+    void Print(std::ostream& os) const {
+      char buff[300];
+      os << "{" << std::endl << "  \"benchmarks\": [";
+      for (size_t i = 0; i < results.size(); i++) {
+        const Result& result = results[i];
+        double mean = 0;
+        for (double sample : result.samples) mean += sample;
+        if (!result.samples.empty()) mean /= result.samples.size();
+
+        sprintf(buff,
+                "\"samples\": %zu, \"mean_ns\": %.1lf, \"min_ns\": %.1lf, \"p50_ns\": %.1lf, \"p90_ns\": %.1lf, "
+                "\"p99_ns\": %.1lf, \"max_ns\": %.1lf",
+                result.samples.size(), mean, Percentile(result.samples, 0), Percentile(result.samples, 50),
+                Percentile(result.samples, 90), Percentile(result.samples, 99), Percentile(result.samples, 100));
+
+        os << (i ? "," : "") << std::endl
+           << "    {\"instance\": \"" << result.instance << "\", \"name\": \"" << result.name
+           << "\", \"input\": \"" << result.input << "\", " << buff << "}";
+      }
+      os << std::endl << "  ]," << std::endl;
+      os << "  \"warmup\": " << warmup << "," << std::endl;
+      os << "  \"repetitions\": " << repetitions << "," << std::endl;
+      os << "  \"checksum\": " << sink << std::endl << "}" << std::endl;
+    }
+
+  private:
+    struct Result {
+        std::string instance;
+        std::string name;
+        std::string input;
+        std::vector<double> samples;
+    };
+
+    //! Nearest-rank percentile of sorted samples.
+    static double Percentile(const std::vector<double>& samples, double p) {
+      if (samples.empty()) return 0;
+      size_t rank = (size_t)(p / 100 * (samples.size() - 1) + 0.5);
+      return samples[std::min(rank, samples.size() - 1)];
+    }
+
+    const int warmup;
+    const int repetitions;
+    double sink;
+    std::vector<Result> results;
+};
+
+#endif  // BENCH_H
@@ -0,0 +1,297 @@
+#include <float.h>
+#include <time.h>
+
+#include <boost/program_options.hpp>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "bench.h"
+#include "hgsadc/adcpopulation.h"
+#include "pdp/moves/balas_simonetti/bsgraph.h"
+#include "pdp/moves/pdp2koptmove.h"
+#include "pdp/moves/pdp2optmove.h"
+#include "pdp/moves/pdp4optmove.h"
+#include "pdp/moves/pdpbsmove.h"
+#include "pdp/moves/pdporoptmove.h"
+#include "pdp/moves/pdprelocatemove.h"
+#include "pdp/pdpinstance.h"
+#include "utils/application.h"
+#include "utils/random.h"
+
+using namespace pdp;
+using namespace std;
+
+/* running parameters example (from the repository root):
+--repetitions=50
+--warmup=5
+--solutions=4
+instances/RBO00/Class1/U159C.PDT instances/PDP-X/X-n101-k25A.pdt
+--bs-k=5 (any pdphgs parameter is forwarded)
+*/
+
+//! Instances benchmarked by default, relative to the repository root.
+static const char* defaultInstances[] = {"instances/RBO00/Class1/U159C.PDT", "instances/RBO00/Class1/PR439A.PDT",
+                                         "instances/PDP-X/X-n101-k25A.pdt", "instances/PDP-X/X-n1001-k43A.pdt"};
+
+namespace {
+
+//! Copy a solution under a new route version, so no neighborhood sees it as a known local optimum.
+void Fresh(PDPSolution& copy, const PDPSolution& solution) {
+  copy = PDPSolution();
+  copy.route = solution.route;
+  copy.Recompute();
+}
+
+//! Get the pickup nodes of the loaded instance.
+vector<PDPNode*> Pickups() {
+  vector<PDPNode*> pickups;
+  PDPNode** nodes = (PDPNode**)Application::instance->Data();
+  for (size_t i = 0; i < Application::instance->Size(); i++) {
+    if (nodes[i]->isPickup) pickups.push_back(nodes[i]);
+  }
+  return pickups;
+}
+
+//! Time the evaluations and the moves of a neighborhood.
+void BenchMove(Bench& bench, const string& file, moves::PDPMove* move, const vector<PDPSolution*>& solutions,
+               const string& input) {
+  vector<PDPNode*> pickups = Pickups();
+  PDPSolution work;
+  PDPNode* node = nullptr;
+  moves::PDPMoveEvaluation eval;
+
+  bench.Measure(
+      file, move->name() + ".Evaluate(node)", input,
+      [&](int r) {
+        Fresh(work, *solutions[r % solutions.size()]);
+        node = pickups[(r * 7919) % pickups.size()];
+        return true;
+      },
+      [&]() { return move->Evaluate(&work, node).cost; });
+
+  bench.Measure(
+      file, move->name() + ".Evaluate(route)", input,
+      [&](int r) {
+        Fresh(work, *solutions[r % solutions.size()]);
+        return true;
+      },
+      [&]() { return move->Evaluate(&work).cost; });
+
+  // the move applies the first improving evaluation, per pickup node then per route
+  bench.Measure(
+      file, move->name() + ".move", input,
+      [&](int r) {
+        Fresh(work, *solutions[r % solutions.size()]);
+        for (size_t i = 0; i < pickups.size(); i++) {
+          eval = move->Evaluate(&work, pickups[(r * 7919 + i) % pickups.size()]);
+          if (work.cost - eval.cost > 0.01) return true;
+        }
+        eval = move->Evaluate(&work);
+        return work.cost - eval.cost > 0.01;
+      },
+      [&]() { return move->move(&work, eval); });
+}
+
+//! Time the genetic operators of the instance.
+void BenchOperators(Bench& bench, const string& file, PDPInstance* instance,
+                    const vector<PDPSolution*>& solutions, const string& input) {
+  PDPSolution child;
+  const PDPSolution* p1 = nullptr;
+  const PDPSolution* p2 = nullptr;
+
+  bench.Measure(
+      file, "PDPInstance::Crossover", input,
+      [&](int r) {
+        p1 = solutions[r % solutions.size()];
+        p2 = solutions[(r + 1) % solutions.size()];
+        return true;
+      },
+      [&]() {
+        instance->Crossover(&child, p1, p2);
+        return child.Cost();
+      });
+
+  bench.Measure(
+      file, "PDPInstance::Mutate", input,
+      [&](int r) {
+        Fresh(child, *solutions[r % solutions.size()]);
+        return true;
+      },
+      [&]() {
+        instance->Mutate(&child);
+        return child.Cost();
+      });
+
+  bench.Measure(
+      file, "PDPInstance::Repair", input,
+      [&](int r) {
+        instance->Crossover(&child, solutions[r % solutions.size()], solutions[(r + 1) % solutions.size()]);
+        return true;
+      },
+      [&]() {
+        instance->Repair(&child);
+        return child.Cost();
+      });
+}
+
+//! Time the population updates, the population being filled with clones of a pool of solutions.
+void BenchPopulation(Bench& bench, const string& file, const vector<PDPSolution*>& pool) {
+  size_t mu = Application::hgsadc_populationSize;
+  ga::ADCPopulation* population = nullptr;
+  ga::Solution* offspring = nullptr;
+
+  auto fill = [&](int r, size_t count) {
+    delete population;
+    population = new ga::ADCPopulation();
+    for (size_t i = 0; i < count; i++) population->Add(pool[(r + i) % pool.size()]->Clone());
+  };
+
+  bench.Measure(
+      file, "ADCPopulation::Add", "random",
+      [&](int r) {
+        fill(r, mu);
+        offspring = pool[(r + mu) % pool.size()]->Clone();
+        return true;
+      },
+      [&]() { return (double)population->Add(offspring); });
+
+  bench.Measure(
+      file, "ADCPopulation::Keep", "random",
+      [&](int r) {
+        fill(r, pool.size());
+        return true;
+      },
+      [&]() {
+        population->Keep(mu);
+        return (double)population->size();
+      });
+
+  delete population;
+}
+
+//! Time the Balas-Simonetti shortest path on whole routes (without cache).
+void BenchBalasSimonetti(Bench& bench, const string& file, PDPInstance* instance,
+                         const vector<PDPSolution*>& solutions, const string& input) {
+  BSGraph graph(Application::bs_k, instance->Size(), instance->Distances(), (clock_t)-1, 0);
+  vector<int> sequence;
+  double distance = 0;
+
+  char name[100];
+  sprintf(name, "BSGraph::runBS(k=%d)", Application::bs_k);
+  bench.Measure(
+      file, name, input,
+      [&](int r) {
+        sequence = solutions[r % solutions.size()]->route;
+        distance = solutions[r % solutions.size()]->cost;
+        return true;
+      },
+      [&]() {
+        graph.runBS(sequence, 1, (int)sequence.size() - 2, distance, BSHash());
+        return graph.distance;
+      });
+}
+
+//! Load an instance through the pdphgs parameters, as main does.
+PDPInstance* LoadInstance(const string& file, const vector<string>& forwarded) {
+  vector<string> args = {"pdtsp_bench", "--instance=" + file};
+  args.insert(args.end(), forwarded.begin(), forwarded.end());
+
+  vector<char*> argv;
+  for (string& arg : args) argv.push_back((char*)arg.c_str());
+
+  boost::program_options::variables_map variablesMap =
+      Application::initializeVariablesMap((int)argv.size(), argv.data());
+  Application::LoadArgs(variablesMap);
+  std::srand((uint)Application::seed);
+
+  PDPInstance* instance = PDPInstance::fromFilePath(file);
+  if (instance == nullptr) return nullptr;
+
+  Application::BeginSolve(instance);
+  return instance;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  boost::program_options::options_description description("pdtsp_bench");
+  boost::program_options::options_description_easy_init add_option = description.add_options();
+
+  add_option("help", "Display a help message.");
+  add_option("warmup", boost::program_options::value<int>()->default_value(3), "Unmeasured repetitions.");
+  add_option("repetitions", boost::program_options::value<int>()->default_value(30), "Measured repetitions.");
+  add_option("solutions", boost::program_options::value<int>()->default_value(2),
+             "Seeded solutions (random and educated) per instance.");
+  add_option("instances", boost::program_options::value<vector<string> >(),
+             "Instance files (default: a few RBO00 and PDP-X instances).");
+
+  boost::program_options::positional_options_description positional;
+  positional.add("instances", -1);
+
+  // unknown options are pdphgs parameters (--seed, --bs-k, --neighborhoods, ...)
+  boost::program_options::parsed_options parsed = boost::program_options::command_line_parser(argc, argv)
+                                                       .options(description)
+                                                       .positional(positional)
+                                                       .allow_unregistered()
+                                                       .run();
+  boost::program_options::variables_map variablesMap;
+  boost::program_options::store(parsed, variablesMap);
+  boost::program_options::notify(variablesMap);
+
+  if (variablesMap.count("help")) {
+    std::cout << description << endl;
+    exit(0);
+  }
+
+  vector<string> forwarded =
+      boost::program_options::collect_unrecognized(parsed.options, boost::program_options::exclude_positional);
+  vector<string> files(defaultInstances, defaultInstances + sizeof(defaultInstances) / sizeof(*defaultInstances));
+  if (variablesMap.count("instances")) files = variablesMap["instances"].as<vector<string> >();
+
+  Bench bench(variablesMap["warmup"].as<int>(), variablesMap["repetitions"].as<int>());
+  int nSolutions = std::max(1, variablesMap["solutions"].as<int>());
+
+  for (const string& file : files) {
+    PDPInstance* instance = LoadInstance(file, forwarded);
+    if (instance == nullptr) {
+      cerr << "Cannot read instance " << file << endl;
+      exit(1);
+    }
+
+    // fixed seeded inputs: random solutions, and the same solutions after a local search
+    vector<PDPSolution*> randomSolutions, educatedSolutions;
+    for (int i = 0; i < nSolutions; i++) {
+      randomSolutions.push_back((PDPSolution*)instance->CreateRandomSolution());
+      educatedSolutions.push_back((PDPSolution*)randomSolutions.back()->Clone());
+      instance->Educate(educatedSolutions.back());
+    }
+
+    vector<PDPSolution*> pool;
+    size_t poolSize = Application::hgsadc_populationSize + Application::hgsadc_offspringInGeneration;
+    for (size_t i = 0; i < poolSize; i++) pool.push_back((PDPSolution*)instance->CreateRandomSolution());
+
+    vector<moves::PDPMove*> neighborhoods = {new moves::PDPRelocateMove(), new moves::PDP2optMove(),
+                                             new moves::PDP2koptMove(),    new moves::PDP4optMove(),
+                                             new moves::PDPOroptMove(),    new moves::PDPBsMove()};
+    for (moves::PDPMove* move : neighborhoods) {
+      BenchMove(bench, file, move, randomSolutions, "random");
+      BenchMove(bench, file, move, educatedSolutions, "educated");
+    }
+
+    BenchOperators(bench, file, instance, educatedSolutions, "educated");
+    BenchPopulation(bench, file, pool);
+    BenchBalasSimonetti(bench, file, instance, randomSolutions, "random");
+    BenchBalasSimonetti(bench, file, instance, educatedSolutions, "educated");
+
+    for (moves::PDPMove* move : neighborhoods) delete move;
+    for (PDPSolution* solution : randomSolutions) delete solution;
+    for (PDPSolution* solution : educatedSolutions) delete solution;
+    for (PDPSolution* solution : pool) delete solution;
+    delete instance;
+    Application::instance = nullptr;
+  }
+
+  bench.Print(std::cout);
+  return 0;
+}
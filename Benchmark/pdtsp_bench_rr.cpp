@@ -0,0 +1,158 @@
+#include <float.h>
+
+#include <algorithm>
+#include <boost/program_options.hpp>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "bench.h"
+#include "instance.h"
+#include "operators.h"
+#include "random.h"
+
+using namespace rr;
+using namespace std;
+
+/* running parameters example (from the repository root):
+--repetitions=50
+--seed=1
+instances/RBO00/Class1/U159C.PDT instances/PDP-X/X-n101-k25A.pdt
+*/
+
+//! Instances benchmarked by default, relative to the repository root.
+static const char* defaultInstances[] = {"instances/RBO00/Class1/U159C.PDT", "instances/RBO00/Class1/PR439A.PDT",
+                                         "instances/PDP-X/X-n101-k25A.pdt", "instances/PDP-X/X-n1001-k43A.pdt"};
+
+namespace {
+
+//! Build a seeded solution, inserting the requests at their best position in random order.
+Solution RandomSolution(const Instance& instance) {
+  Solution sol;
+  sol.visits.push_back(0);
+  sol.visits.push_back(0);
+  sol.cost = 0;
+
+  Instance::NodeList pickups = instance.Pickups();
+  Random::shuffle(pickups.begin(), pickups.end());
+  for (const Instance::Node* pickup : pickups) {
+    int insertPosition[2];
+    sol.cost +=
+        Operators::EvaluateBestInsertionFast(instance, sol.visits, pickup->idx, pickup->pair, insertPosition);
+    Operators::InsertRequest(sol.visits, pickup->idx, pickup->pair, insertPosition);
+  }
+  return sol;
+}
+
+//! Time the removal and reinsertion operators of the ruin and recreate.
+void BenchOperators(Bench& bench, const string& file, const Instance& instance,
+                    const vector<Solution>& solutions) {
+  Instance::NodeList pickups = instance.Pickups();
+  Solution work;
+  const Instance::Node* request = nullptr;
+  int insertPosition[2];
+
+  // the work solution and the request of repetition r
+  auto prepare = [&](int r, bool removed) {
+    work = solutions[r % solutions.size()];
+    request = pickups[(r * 7919) % pickups.size()];
+    if (removed) work.cost += Operators::RemoveRequest(instance, work.visits, request->idx, request->pair);
+    return true;
+  };
+
+  bench.Measure(
+      file, "Operators::EvaluateRemoveRequest", "random", [&](int r) { return prepare(r, false); },
+      [&]() { return Operators::EvaluateRemoveRequest(instance, work.visits, request->idx, request->pair); });
+
+  bench.Measure(
+      file, "Operators::RemoveRequest", "random", [&](int r) { return prepare(r, false); },
+      [&]() { return Operators::RemoveRequest(instance, work.visits, request->idx, request->pair); });
+
+  bench.Measure(
+      file, "Operators::EvaluateBestInsertion", "random", [&](int r) { return prepare(r, true); },
+      [&]() {
+        return Operators::EvaluateBestInsertion(instance, work.visits, request->idx, request->pair,
+                                                insertPosition);
+      });
+
+  bench.Measure(
+      file, "Operators::EvaluateBestInsertionFast", "random", [&](int r) { return prepare(r, true); },
+      [&]() {
+        return Operators::EvaluateBestInsertionFast(instance, work.visits, request->idx, request->pair,
+                                                    insertPosition);
+      });
+
+  bench.Measure(
+      file, "Operators::InsertRequest", "random",
+      [&](int r) {
+        prepare(r, true);
+        Operators::EvaluateBestInsertionFast(instance, work.visits, request->idx, request->pair, insertPosition);
+        return true;
+      },
+      [&]() {
+        Operators::InsertRequest(work.visits, request->idx, request->pair, insertPosition);
+        return (double)work.visits.size();
+      });
+
+  // removal sizes of the solver: between qMin and qMax requests
+  int n = instance.nodes.size() / 2;
+  int q = (std::min(30, int(0.20 * n)) + std::min(50, int(0.55 * n))) / 2;
+  const Operators::PtrRemoveOperator removals[] = {Operators::RandomRemoval, Operators::WorstDistanceRemoval,
+                                                   Operators::BlockRemoval};
+  const char* names[] = {"Operators::RandomRemoval", "Operators::WorstDistanceRemoval",
+                         "Operators::BlockRemoval"};
+  for (int i = 0; i < 3; i++) {
+    bench.Measure(
+        file, names[i], "random", [&](int r) { return prepare(r, false); },
+        [&]() { return (double)removals[i](instance, work, q, 3.0).size(); });
+  }
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  boost::program_options::options_description description("pdtsp_bench_rr");
+  boost::program_options::options_description_easy_init add_option = description.add_options();
+
+  add_option("help", "Display a help message.");
+  add_option("seed", boost::program_options::value<int>()->default_value(0), "Sets a random seed.");
+  add_option("warmup", boost::program_options::value<int>()->default_value(3), "Unmeasured repetitions.");
+  add_option("repetitions", boost::program_options::value<int>()->default_value(30), "Measured repetitions.");
+  add_option("solutions", boost::program_options::value<int>()->default_value(2),
+             "Seeded solutions per instance.");
+  add_option("instances", boost::program_options::value<vector<string> >(),
+             "Instance files (default: a few RBO00 and PDP-X instances).");
+
+  boost::program_options::positional_options_description positional;
+  positional.add("instances", -1);
+
+  boost::program_options::variables_map variablesMap;
+  boost::program_options::store(
+      boost::program_options::command_line_parser(argc, argv).options(description).positional(positional).run(),
+      variablesMap);
+  boost::program_options::notify(variablesMap);
+
+  if (variablesMap.count("help")) {
+    std::cout << description << endl;
+    exit(0);
+  }
+
+  vector<string> files(defaultInstances, defaultInstances + sizeof(defaultInstances) / sizeof(*defaultInstances));
+  if (variablesMap.count("instances")) files = variablesMap["instances"].as<vector<string> >();
+
+  Bench bench(variablesMap["warmup"].as<int>(), variablesMap["repetitions"].as<int>());
+  int nSolutions = std::max(1, variablesMap["solutions"].as<int>());
+
+  for (const string& file : files) {
+    std::srand((uint)variablesMap["seed"].as<int>());
+    Instance instance(file);
+
+    vector<Solution> solutions;
+    for (int i = 0; i < nSolutions; i++) solutions.push_back(RandomSolution(instance));
+
+    BenchOperators(bench, file, instance, solutions);
+  }
+
+  bench.Print(std::cout);
+  return 0;
+}
@@ -0,0 +1,205 @@
+#include <math.h>
+
+#include <algorithm>
+#include <boost/program_options.hpp>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/* running parameters example:
+--requests=5000 --layout=clustered --clusters=40 --pair-radius=0.1 --seed=1 --output=C5000.pdt
+--requests=2000 --layout=mixed --format=grubhub --output=G2000.pdt (run pdphgs with --grubhub)
+*/
+
+namespace {
+
+//! Random generator giving the same instances on every platform (the standard distributions do not).
+class Generator {
+  public:
+    explicit Generator(unsigned int seed) : engine(seed) {
+    }
+
+    //! Uniform double on [0, 1).
+    double Real() {
+      return engine() / 4294967296.0;
+    }
+
+    //! Uniform integer on [0, n).
+    int Int(int n) {
+      return std::min(n - 1, (int)(Real() * n));
+    }
+
+    //! Standard normal deviate (Box-Muller).
+    double Normal() {
+      double u = 1 - Real();
+      return sqrt(-2 * log(u)) * cos(2 * M_PI * Real());
+    }
+
+  private:
+    std::mt19937 engine;
+};
+
+struct Point {
+    int x;
+    int y;
+};
+
+//! Layout of the locations.
+class Layout {
+  public:
+    Layout(const string& kind, int clusters, int grid, Generator& generator)
+        : kind(kind), grid(grid), generator(generator) {
+      for (int c = 0; c < clusters; c++) {
+        Point center = {generator.Int(grid + 1), generator.Int(grid + 1)};
+        centers.push_back(center);
+      }
+
+      // clusters cover about half of the grid side together
+      spread = grid / (4.0 * sqrt((double)std::max(clusters, 1)));
+    }
+
+    //! Draw a location.
+    Point Draw() {
+      bool clustered = kind == "clustered" || (kind == "mixed" && generator.Real() < 0.5);
+      if (!clustered || centers.empty()) {
+        Point point = {generator.Int(grid + 1), generator.Int(grid + 1)};
+        return point;
+      }
+
+      const Point& center = centers[generator.Int((int)centers.size())];
+      return Clamp(center.x + spread * generator.Normal(), center.y + spread * generator.Normal());
+    }
+
+    //! Draw a location within a radius of another one.
+    Point Near(const Point& point, double radius) {
+      double angle = 2 * M_PI * generator.Real();
+      double distance = radius * sqrt(generator.Real());
+      return Clamp(point.x + distance * cos(angle), point.y + distance * sin(angle));
+    }
+
+  private:
+    Point Clamp(double x, double y) const {
+      Point point = {std::max(0, std::min(grid, (int)lround(x))), std::max(0, std::min(grid, (int)lround(y)))};
+      return point;
+    }
+
+    const string kind;
+    const int grid;
+    Generator& generator;
+    vector<Point> centers;
+    double spread;
+};
+
+//! RBO00 format: depot, pickups 1..n, deliveries n+1..2n (1-based indices after the depot).
+void WriteRbo(ostream& os, const Point& depot, const vector<Point>& pickups, const vector<Point>& deliveries) {
+  int n = (int)pickups.size();
+  os << 2 * n + 1 << endl;
+  os << "1 " << depot.x << " " << depot.y << endl;
+  for (int i = 0; i < n; i++) {
+    os << i + 2 << " " << pickups[i].x << " " << pickups[i].y << " 0 " << n + i + 2 << endl;
+  }
+  for (int i = 0; i < n; i++) {
+    os << n + i + 2 << " " << deliveries[i].x << " " << deliveries[i].y << " 1 " << i + 2 << endl;
+  }
+  os << "-999" << endl;
+}
+
+//! Grubhub format: distance matrix with consecutive pickup-delivery rows, returning to the depot for free.
+void WriteGrubhub(ostream& os, const string& name, const Point& depot, const vector<Point>& pickups,
+                  const vector<Point>& deliveries) {
+  vector<Point> points(1, depot);
+  for (size_t i = 0; i < pickups.size(); i++) {
+    points.push_back(pickups[i]);
+    points.push_back(deliveries[i]);
+  }
+
+  os << "GRUBHUB: " << name << endl;
+  os << "DIMENSION: " << points.size() << endl;
+  for (size_t i = 0; i < points.size(); i++) {
+    for (size_t j = 0; j < points.size(); j++) {
+      double dx = points[i].x - points[j].x;
+      double dy = points[i].y - points[j].y;
+      int distance = (i == j || j == 0) ? 0 : (int)(sqrt(dx * dx + dy * dy) + 0.5);
+      os << (j ? " " : "") << distance;
+    }
+    os << endl;
+  }
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  boost::program_options::options_description description("pdtsp_generate");
+  boost::program_options::options_description_easy_init add_option = description.add_options();
+
+  add_option("help", "Display a help message.");
+  add_option("requests", boost::program_options::value<int>()->default_value(500),
+             "Number of pickup-delivery pairs (the instance has 2 * requests + 1 locations).");
+  add_option("layout", boost::program_options::value<string>()->default_value("uniform"),
+             "Location layout: uniform, clustered or mixed (half clustered, half uniform).");
+  add_option("clusters", boost::program_options::value<int>()->default_value(10),
+             "Number of clusters of the clustered and mixed layouts.");
+  add_option("pair-radius", boost::program_options::value<double>()->default_value(0.0),
+             "Maximum distance from a pickup to its delivery, as a fraction of the grid side "
+             "(0 draws the delivery from the layout, independently of the pickup).");
+  add_option("grid", boost::program_options::value<int>()->default_value(1000), "Side of the square grid.");
+  add_option("format", boost::program_options::value<string>()->default_value("rbo"),
+             "Output format: rbo (RBO00) or grubhub (distance matrix, O(n^2) size).");
+  add_option("name", boost::program_options::value<string>()->default_value("synthetic"),
+             "Instance name (Grubhub header).");
+  add_option("seed", boost::program_options::value<int>()->default_value(0), "Sets a random seed.");
+  add_option("output", boost::program_options::value<string>(), "Output file (default: standard output).");
+
+  boost::program_options::variables_map variablesMap;
+  boost::program_options::store(
+      boost::program_options::command_line_parser(argc, argv).options(description).run(), variablesMap);
+  boost::program_options::notify(variablesMap);
+
+  if (variablesMap.count("help")) {
+    std::cout << description << endl;
+    exit(0);
+  }
+
+  int requests = variablesMap["requests"].as<int>();
+  int grid = variablesMap["grid"].as<int>();
+  double pairRadius = variablesMap["pair-radius"].as<double>() * grid;
+  string layoutKind = variablesMap["layout"].as<string>();
+  string format = variablesMap["format"].as<string>();
+
+  if (requests < 1 || grid < 1 || (layoutKind != "uniform" && layoutKind != "clustered" && layoutKind != "mixed") ||
+      (format != "rbo" && format != "grubhub")) {
+    cerr << "Invalid parameters. Use --help for more information" << endl;
+    exit(1);
+  }
+
+  Generator generator((unsigned int)variablesMap["seed"].as<int>());
+  Layout layout(layoutKind, variablesMap["clusters"].as<int>(), grid, generator);
+
+  Point depot = {grid / 2, grid / 2};
+  vector<Point> pickups, deliveries;
+  for (int i = 0; i < requests; i++) {
+    pickups.push_back(layout.Draw());
+    deliveries.push_back(pairRadius > 0 ? layout.Near(pickups.back(), pairRadius) : layout.Draw());
+  }
+
+  ofstream file;
+  if (variablesMap.count("output")) {
+    file.open(variablesMap["output"].as<string>());
+    if (!file.is_open()) {
+      cerr << "Cannot write " << variablesMap["output"].as<string>() << endl;
+      exit(1);
+    }
+  }
+  ostream& os = file.is_open() ? file : cout;
+
+  if (format == "rbo") {
+    WriteRbo(os, depot, pickups, deliveries);
+  } else {
+    WriteGrubhub(os, variablesMap["name"].as<string>(), depot, pickups, deliveries);
+  }
+  return 0;
+}
@@ -0,0 +1,331 @@
+#include <math.h>
+#include <stdio.h>
+
+#include <algorithm>
+#include <boost/algorithm/string.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../Library/pdtsp.h"
+#include "pdp/pdpinstance.h"
+#include "utils/application.h"
+
+using namespace std;
+
+/* running parameters example (from the repository root):
+--time-limit=10
+--seeds=5
+--config="hgs=pdphgs"
+--config="hgs-bs5=pdphgs --bs-k=5"
+--config="rr=pdprr --fast"
+--format=json
+instances/PDP-X/X-n101-k25A.pdt instances/Dumitrescu/prob35a.txt
+*/
+
+//! Instances run by default, relative to the repository root.
+static const char* defaultInstances[] = {"instances/PDP-X/X-n101-k25A.pdt", "instances/PDP-X/X-n200-k36A.pdt",
+                                         "instances/Dumitrescu/prob35a.txt"};
+
+//! Configurations run by default: name=solver arguments.
+static const char* defaultConfigs[] = {"hgs=pdphgs", "rr=pdprr --fast"};
+
+namespace {
+
+//! Solver configuration: a name, pdphgs or pdprr and its options (without instance and seed).
+struct Config {
+    string name;
+    pdtsp::Algorithm algorithm;
+    vector<string> options;
+};
+
+//! Outcome of a solver run and its quality measures against the reference solution.
+struct Run {
+    string config;
+    string instance;
+    int seed;
+    double reference;
+    double cost;
+
+    //! wall-clock time of the solve in seconds.
+    double time;
+
+    //! process CPU time of the solve in seconds, as measured by the solver.
+    double cpu;
+    double educate;
+
+    //! wall-clock time and cost of each improvement of the best solution.
+    vector<pair<double, double> > evolution;
+
+    //! time to reach each target gap (-1 if never reached).
+    vector<double> timeToTarget;
+    double primalIntegral;
+
+    double Gap() const {
+      return 100 * (cost - reference) / reference;
+    }
+};
+
+//! Read the cost of the reference solution shipped next to an instance (.sol file).
+double ReadReference(const string& instance) {
+  boost::property_tree::ptree tree;
+  boost::property_tree::read_json(boost::filesystem::path(instance).replace_extension(".sol").string(), tree);
+  return tree.get<double>("cost");
+}
+
+//! Read an instance file as pdphgs does (a distance matrix with --grubhub).
+pdtsp::InstanceData ReadInstance(const string& file, bool grubhub) {
+  Application::grubhubmode = grubhub;
+  pdp::PDPInstance* instance = pdp::PDPInstance::fromFilePath(file);
+  if (instance == nullptr) throw runtime_error("Cannot read instance " + file);
+
+  pdtsp::InstanceData data;
+  for (const PDPNode* node : instance->nodes) data.nodes.push_back({node->x, node->y, node->pair, node->isPickup});
+  if (!instance->euclidean) {
+    double** distances = instance->Distances();
+    for (size_t i = 0; i < instance->Size(); i++)
+      data.distances.push_back(vector<double>(distances[i], distances[i] + instance->Size()));
+  }
+  delete instance;
+  return data;
+}
+
+//! Solve an instance in this process, timestamping the improvements with the steady clock.
+//! \return bool: false if the solver rejected the instance or its options.
+bool Execute(const Config& config, const pdtsp::InstanceData& instance, int timeLimit, Run& run) {
+  pdtsp::Params params;
+  params.algorithm = config.algorithm;
+  params.seed = run.seed;
+  params.wallLimit = timeLimit;
+  params.options = config.options;
+
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  pdtsp::Callbacks callbacks;
+  callbacks.improvement = [&run, start](const vector<int>&, double cost, double) {
+    run.evolution.push_back(make_pair(chrono::duration<double>(chrono::steady_clock::now() - start).count(), cost));
+  };
+
+  try {
+    pdtsp::Result result = pdtsp::Solve(instance, params, callbacks);
+    run.time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    run.cost = result.cost;
+    run.cpu = result.time;
+    run.educate = (double)result.educations;
+  } catch (const exception& e) {
+    cerr << e.what() << endl;
+    return false;
+  }
+  return true;
+}
+
+//! Compute the time to each target gap and the primal integral of a run.
+//! \param targets: target gaps in percent.
+//! \param horizon: end of the primal integral (the time budget, or the run time without budget).
+void Measure(Run& run, const vector<double>& targets, double horizon) {
+  horizon = max(horizon, run.time);
+
+  for (double target : targets) {
+    double reached = -1;
+    for (const pair<double, double>& entry : run.evolution) {
+      if (100 * (entry.second - run.reference) / run.reference <= target + 1e-9) {
+        reached = entry.first;
+        break;
+      }
+    }
+    run.timeToTarget.push_back(reached);
+  }
+
+  // primal integral (Berthold, 2013): the gap function is 1 until the first solution, then
+  // |cost - reference| / max(cost, reference) for the best cost found so far
+  double integral = 0;
+  double last = 0;
+  double gap = 1;
+  for (const pair<double, double>& entry : run.evolution) {
+    double time = min(entry.first, horizon);
+    integral += gap * (time - last);
+    last = time;
+    gap = fabs(entry.second - run.reference) / max(entry.second, run.reference);
+  }
+  integral += gap * (horizon - last);
+  run.primalIntegral = integral;
+}
+
+//! Print a measure.
+string Value(double value) {
+  char buff[50];
+  sprintf(buff, "%.4lf", value);
+  return buff;
+}
+
+//! Print a time to target, empty (CSV) or null (JSON) when the target was not reached.
+string TimeToTarget(double value, bool json) {
+  if (value < 0) return json ? "null" : "";
+  return Value(value);
+}
+
+void PrintCsv(const vector<Run>& runs, const vector<double>& targets) {
+  cout << "config,instance,seed,reference,cost,gap,time,cpu,educate_per_s,primal_integral";
+  for (double target : targets) cout << ",ttt_" << target;
+  cout << endl;
+
+  for (const Run& run : runs) {
+    cout << run.config << "," << run.instance << "," << run.seed << "," << run.reference << "," << run.cost << ","
+         << Value(run.Gap()) << "," << Value(run.time) << "," << Value(run.cpu) << ","
+         << Value(run.educate / run.time) << "," << Value(run.primalIntegral);
+    for (double ttt : run.timeToTarget) cout << "," << TimeToTarget(ttt, false);
+    cout << endl;
+  }
+}
+
+void PrintJson(const vector<Run>& runs, const vector<Config>& configs, const vector<double>& targets) {
+  cout << "{" << endl << "  \"runs\": [";
+  for (size_t i = 0; i < runs.size(); i++) {
+    const Run& run = runs[i];
+    cout << (i ? "," : "") << endl
+         << "    {\"config\": \"" << run.config << "\", \"instance\": \"" << run.instance
+         << "\", \"seed\": " << run.seed << ", \"reference\": " << run.reference << ", \"cost\": " << run.cost
+         << ", \"gap\": " << Value(run.Gap()) << ", \"time\": " << Value(run.time)
+         << ", \"cpu\": " << Value(run.cpu) << ", \"educate_per_s\": " << Value(run.educate / run.time)
+         << ", \"primal_integral\": " << Value(run.primalIntegral);
+    for (size_t t = 0; t < targets.size(); t++)
+      cout << ", \"ttt_" << targets[t] << "\": " << TimeToTarget(run.timeToTarget[t], true);
+    cout << "}";
+  }
+  cout << endl << "  ]," << endl << "  \"summary\": [";
+
+  // per configuration: mean measures and fraction of runs reaching each target
+  bool first = true;
+  for (size_t c = 0; c < configs.size(); c++) {
+    int count = 0;
+    double gap = 0, integral = 0, educate = 0;
+    vector<int> reached(targets.size(), 0);
+    for (const Run& run : runs) {
+      if (run.config != configs[c].name) continue;
+      count++;
+      gap += run.Gap();
+      integral += run.primalIntegral;
+      educate += run.educate / run.time;
+      for (size_t t = 0; t < targets.size(); t++) reached[t] += run.timeToTarget[t] >= 0;
+    }
+    if (count == 0) continue;
+
+    cout << (first ? "" : ",") << endl
+         << "    {\"config\": \"" << configs[c].name << "\", \"runs\": " << count
+         << ", \"mean_gap\": " << Value(gap / count)
+         << ", \"mean_primal_integral\": " << Value(integral / count)
+         << ", \"mean_educate_per_s\": " << Value(educate / count);
+    for (size_t t = 0; t < targets.size(); t++)
+      cout << ", \"reached_" << targets[t] << "\": " << Value(reached[t] / (double)count);
+    cout << "}";
+    first = false;
+  }
+  cout << endl << "  ]" << endl << "}" << endl;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  boost::program_options::options_description description("pdtsp_ttt");
+  boost::program_options::options_description_easy_init add_option = description.add_options();
+
+  add_option("help", "Display a help message.");
+  add_option("config", boost::program_options::value<vector<string> >(),
+             "Solver configuration as name=solver options, the solver being pdphgs or pdprr (default: hgs=pdphgs "
+             "and rr=pdprr --fast).");
+  add_option("instances", boost::program_options::value<vector<string> >(),
+             "Instance files, with their .sol reference next to them (default: PDP-X and Dumitrescu instances).");
+  add_option("seeds", boost::program_options::value<int>()->default_value(3), "Seeds 0..seeds-1 of every run.");
+  add_option("time-limit", boost::program_options::value<int>()->default_value(10),
+             "Wall-clock time limit of every run in seconds, passed to the solver (0 to run each solver until its "
+             "own stopping criterion).");
+  add_option("targets", boost::program_options::value<string>()->default_value("1,0.1"),
+             "Target gaps to the reference, in percent.");
+  add_option("format", boost::program_options::value<string>()->default_value("csv"), "Output format (csv or json).");
+
+  boost::program_options::positional_options_description positional;
+  positional.add("instances", -1);
+
+  boost::program_options::variables_map variablesMap;
+  boost::program_options::store(
+      boost::program_options::command_line_parser(argc, argv).options(description).positional(positional).run(),
+      variablesMap);
+  boost::program_options::notify(variablesMap);
+
+  if (variablesMap.count("help")) {
+    std::cout << description << endl;
+    exit(0);
+  }
+
+  vector<string> files(defaultInstances, defaultInstances + sizeof(defaultInstances) / sizeof(*defaultInstances));
+  if (variablesMap.count("instances")) files = variablesMap["instances"].as<vector<string> >();
+
+  vector<string> configArgs(defaultConfigs, defaultConfigs + sizeof(defaultConfigs) / sizeof(*defaultConfigs));
+  if (variablesMap.count("config")) configArgs = variablesMap["config"].as<vector<string> >();
+
+  vector<Config> configs;
+  for (const string& arg : configArgs) {
+    size_t split = arg.find('=');
+    vector<string> words;
+    if (split != string::npos) {
+      string command = boost::algorithm::trim_copy(arg.substr(split + 1));
+      boost::algorithm::split(words, command, boost::algorithm::is_space(), boost::algorithm::token_compress_on);
+    }
+    if (words.empty() || (words[0] != "pdphgs" && words[0] != "pdprr")) {
+      cerr << "Invalid configuration " << arg << " (expected name=pdphgs|pdprr options)" << endl;
+      exit(1);
+    }
+    Config config;
+    config.name = arg.substr(0, split);
+    config.algorithm = (words[0] == "pdprr") ? pdtsp::RR : pdtsp::HGS;
+    config.options.assign(words.begin() + 1, words.end());
+    configs.push_back(config);
+  }
+
+  vector<double> targets;
+  stringstream targetList(variablesMap["targets"].as<string>());
+  for (string target; getline(targetList, target, ',');) targets.push_back(stod(target));
+
+  int seeds = variablesMap["seeds"].as<int>();
+  int timeLimit = variablesMap["time-limit"].as<int>();
+
+  vector<Run> runs;
+  for (const string& file : files) {
+    double reference = ReadReference(file);
+
+    for (const Config& config : configs) {
+      bool grubhub = find(config.options.begin(), config.options.end(), "--grubhub") != config.options.end();
+      pdtsp::InstanceData instance = ReadInstance(file, grubhub);
+
+      for (int seed = 0; seed < seeds; seed++) {
+        Run run;
+        run.config = config.name;
+        run.instance = file;
+        run.seed = seed;
+        run.reference = reference;
+
+        cerr << config.name << " " << file << " seed " << seed << endl;
+        if (!Execute(config, instance, timeLimit, run)) {
+          cerr << "Run failed: " << config.name << " " << file << " seed " << seed << endl;
+          exit(1);
+        }
+
+        Measure(run, targets, timeLimit);
+        runs.push_back(run);
+      }
+    }
+  }
+
+  if (variablesMap["format"].as<string>() == "json") {
+    PrintJson(runs, configs, targets);
+  } else {
+    PrintCsv(runs, targets);
+  }
+  return 0;
+}
@@ -0,0 +1,137 @@
+#include "pdtsp.h"
+
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+#include "pdp/pdpinstance.h"
+#include "pdp/pdpnode.h"
+#include "pdtsp_solvers.h"
+#include "utils/application.h"
+
+using namespace std;
+
+namespace pdtsp {
+
+namespace {
+
+//! Check that the nodes are a depot followed by paired pickups and deliveries.
+void Validate(const InstanceData& instance) {
+  const vector<Node>& nodes = instance.nodes;
+  int n = (int)nodes.size();
+  if (n < 3 || n % 2 == 0) throw invalid_argument("The instance needs a depot and pickup-delivery pairs.");
+
+  for (int i = 1; i < n; i++) {
+    int pair = nodes[i].pair;
+    bool pickup = nodes[i].isPickup;
+    if (pair < 1 || pair >= n || pair == i || nodes[pair].pair != i || nodes[pair].isPickup == pickup)
+      throw invalid_argument("Node " + to_string(i) + " is not paired with a node of the other type.");
+  }
+
+  if (!instance.distances.empty()) {
+    if ((int)instance.distances.size() != n) throw invalid_argument("The distance matrix is not n x n.");
+    for (const vector<double>& row : instance.distances) {
+      if ((int)row.size() != n) throw invalid_argument("The distance matrix is not n x n.");
+    }
+  }
+}
+
+//! Build the command line of a solver from the parameters.
+vector<string> Arguments(const char* program, const Params& params) {
+  vector<string> args = {program, "--seed=" + to_string(params.seed)};
+  if (params.iterations > 0) args.push_back("--it=" + to_string(params.iterations));
+  if (params.timeLimit > 0) args.push_back("--time-limit=" + to_string(params.timeLimit));
+  if (params.wallLimit > 0) args.push_back("--wall-limit=" + to_string(params.wallLimit));
+  if (params.workLimit > 0) args.push_back("--work-limit=" + to_string(params.workLimit));
+  args.insert(args.end(), params.options.begin(), params.options.end());
+
+  // re-planning defaults, unless the options give them
+  if (params.replan && params.algorithm == HGS) {
+    const pair<string, string> defaults[] = {{"--initial-fill", "=0"}, {"--initial-local", "=1"}};
+    for (const pair<string, string>& option : defaults) {
+      bool given = false;
+      for (const string& arg : params.options) {
+        if (arg.compare(0, option.first.size(), option.first) == 0) given = true;
+      }
+      if (!given) args.push_back(option.first + option.second);
+    }
+  }
+  return args;
+}
+
+// both solvers keep their parameters and their instance in static members
+mutex solveMutex;
+
+}  // namespace
+
+Instance::Instance(const InstanceData& data) {
+  Validate(data);
+
+  NodeList nodes;
+  for (size_t i = 0; i < data.nodes.size(); i++) {
+    PDPNode* node = new PDPNode();
+    node->idx = i;
+    node->x = data.nodes[i].x;
+    node->y = data.nodes[i].y;
+    node->pair = i > 0 ? data.nodes[i].pair : 0;
+    node->isPickup = i > 0 && data.nodes[i].isPickup;
+    node->isDelivery = i > 0 && !data.nodes[i].isPickup;
+    nodes.push_back(node);
+  }
+
+  // the neighborhoods depend on the options of each solve, they are built by Solve
+  precomputed.reset(new pdp::PDPInstance(DEFAULT_CLOSE, nodes));
+  if (!data.distances.empty()) precomputed->SetDistances(data.distances);
+  precomputed->PrecomputeData();
+}
+
+Instance::~Instance() {
+}
+
+InstanceData Instance::Data() const {
+  InstanceData data;
+  size_t n = precomputed->Size();
+  for (const PDPNode* node : precomputed->nodes)
+    data.nodes.push_back({node->x, node->y, node->pair, node->isPickup});
+  if (!precomputed->euclidean) {
+    double** distances = precomputed->Distances();
+    for (size_t i = 0; i < n; i++) data.distances.push_back(vector<double>(distances[i], distances[i] + n));
+  }
+  return data;
+}
+
+vector<int> Update(Instance& instance, const Changes& changes, vector<vector<int> >& routes) {
+  vector<vector<double> > added;
+  for (const pair<Node, Node>& request : changes.added)
+    added.push_back({request.first.x, request.first.y, request.second.x, request.second.y});
+
+  vector<int> renumber;
+  try {
+    instance.precomputed.reset(pdp::PDPInstance::Update(*instance.precomputed, added, changes.removed,
+                                                        changes.distances, changes.distancesTo, renumber));
+  } catch (const runtime_error& e) {
+    throw invalid_argument(e.what());
+  }
+
+  for (vector<int>& route : routes) route = pdp::PDPInstance::Renumber(route, renumber);
+  return renumber;
+}
+
+Result Solve(Instance& instance, const Params& params, Callbacks& callbacks) {
+  lock_guard<mutex> lock(solveMutex);
+  if (params.algorithm == RR) return SolveRR(instance.Data(), params, Arguments("pdprr", params), callbacks);
+  return SolveHGS(*instance.precomputed, params, Arguments("pdphgs", params), callbacks);
+}
+
+Result Solve(const InstanceData& instance, const Params& params, Callbacks& callbacks) {
+  if (params.algorithm == HGS) {
+    Instance precomputed(instance);
+    return Solve(precomputed, params, callbacks);
+  }
+
+  Validate(instance);
+  lock_guard<mutex> lock(solveMutex);
+  return SolveRR(instance, params, Arguments("pdprr", params), callbacks);
+}
+
+}  // namespace pdtsp
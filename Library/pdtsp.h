@@ -0,0 +1,198 @@
+/*MIT License
+ *
+Copyright(c) 2022 Toni Pacheco
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+#ifndef PDTSP_H
+#define PDTSP_H
+
+#include <stdint.h>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace pdp {
+class PDPInstance;
+}
+
+//! In-process solve API of the HGS (pdphgs) and Ruin and Recreate (pdprr) solvers: the instance is
+//! given in memory and the result is returned, without reading files or printing to the standard
+//! output (unless --verbose is passed in the options).
+namespace pdtsp {
+
+//! Location of an instance.
+struct Node {
+    //! x coord
+    double x;
+
+    //! y coord
+    double y;
+
+    //! index of the paired node (0 for the depot)
+    int pair;
+
+    //! flag that indicates if it's a pickup node (false for deliveries and for the depot)
+    bool isPickup;
+};
+
+//! Instance given in memory: node 0 is the depot, the other nodes are paired pickups and deliveries.
+struct InstanceData {
+    std::vector<Node> nodes;
+
+    //! Distance matrix, or empty for the rounded Euclidean distances of the nodes.
+    std::vector<std::vector<double> > distances;
+};
+
+//! Solver to run.
+enum Algorithm { HGS, RR };
+
+//! Solver parameters, a limit left at 0 keeping the solver default.
+struct Params {
+    Algorithm algorithm = HGS;
+
+    //! Random seed.
+    int seed = 0;
+
+    //! HGS iterations without improvement, or RR iterations.
+    int iterations = 0;
+
+    //! Execution time limit in seconds, counting the CPU time of every thread (see --threads).
+    int timeLimit = 0;
+
+    //! Wall-clock time limit in seconds.
+    double wallLimit = 0;
+
+    //! Work limit in deterministic units (see --work-limit).
+    uint64_t workLimit = 0;
+
+    //! Other command line options of pdphgs or pdprr (e.g. "--bs-k=5" or "--fast").
+    std::vector<std::string> options;
+
+    //! Routes to start from (warm start), repaired if they miss or misplace requests.
+    std::vector<std::vector<int> > initial;
+
+    //! The initial routes are a previous Result::population updated by Update (re-planning): they fill the
+    //! population alone and are only educated around the added requests ("--initial-fill=0" and
+    //! "--initial-local=1", unless given in the options).
+    bool replan = false;
+};
+
+struct EvolutionEntry {
+    size_t iteration;
+    double time;
+    double cost;
+};
+
+struct Result {
+    //! Best route found, starting and ending at the depot.
+    std::vector<int> route;
+    double cost;
+
+    //! Solve time in seconds.
+    double time;
+
+    //! Solve work in deterministic units.
+    uint64_t work;
+
+    //! Educations of the HGS, or iterations of the RR.
+    size_t educations;
+
+    //! Improvements of the best solution.
+    std::vector<EvolutionEntry> evolution;
+
+    //! Routes of the final HGS population, the best first (warm start of the next re-planning).
+    std::vector<std::vector<int> > population;
+};
+
+struct Callbacks {
+    //! Called with each new best route, its cost and the time it was found.
+    std::function<void(const std::vector<int>& route, double cost, double time)> improvement;
+};
+
+//! Requests added to and removed from an instance (re-planning).
+struct Changes {
+    //! Pickup and delivery of each added request (their pair and isPickup are set by Update).
+    std::vector<std::pair<Node, Node> > added;
+
+    //! A node (pickup or delivery) of each removed request.
+    std::vector<int> removed;
+
+    //! Distances from each added node (pickup, then delivery) to every node of the updated instance.
+    //! Required if the instance has a distance matrix.
+    std::vector<std::vector<double> > distances;
+
+    //! Distances from every node of the updated instance to each added node (a column per added node),
+    //! required with distances. The distances between two added nodes are taken from distances.
+    std::vector<std::vector<double> > distancesTo;
+};
+
+//! Instance kept precomputed between the solves of a day (re-planning): its distance matrix and closest
+//! customers are computed once and patched by Update, so that a solve only builds its neighborhoods. An
+//! instance is not shared by concurrent calls.
+class Instance {
+  public:
+    //! \throw std::invalid_argument: if the instance is not a valid PDTSP instance.
+    explicit Instance(const InstanceData& data);
+    ~Instance();
+
+    Instance(const Instance&) = delete;
+    Instance& operator=(const Instance&) = delete;
+
+    //! Nodes and distances of the instance, as updated (no distances if they are Euclidean).
+    InstanceData Data() const;
+
+  private:
+    std::unique_ptr<pdp::PDPInstance> precomputed;
+
+    friend std::vector<int> Update(Instance& instance, const Changes& changes,
+                                   std::vector<std::vector<int> >& routes);
+    friend Result Solve(Instance& instance, const Params& params, Callbacks& callbacks);
+};
+
+//! Add and remove requests of an instance, between two solves of a day. The kept nodes keep their
+//! order and the added pickups and deliveries follow them, so the distance matrix and the closest
+//! customers are only patched. The next Solve, warm started from the updated routes (e.g.
+//! Result::population with Params::replan), inserts the added requests at their best position, educates
+//! the routes around them and continues the search.
+//! \param instance: instance updated in place.
+//! \param changes: added and removed requests.
+//! \param routes: routes mapped to the updated nodes, the removed nodes being dropped.
+//! \return std::vector<int>: index of each former node in the updated instance (-1 if removed).
+//! \throw std::invalid_argument: if a removed node is unknown, a distance is missing or no request is left.
+std::vector<int> Update(Instance& instance, const Changes& changes, std::vector<std::vector<int> >& routes);
+
+//! Solve an instance. The solvers keep their parameters in static members, so the solves of a
+//! process are serialized, and the HGS thread pool is resized to the --threads of each solve.
+//! \param instance: precomputed instance (see Instance).
+//! \param params: solver parameters.
+//! \param callbacks: functions called during the solve.
+//! \return Result: best route found, its cost and the evolution of the solve.
+Result Solve(Instance& instance, const Params& params, Callbacks& callbacks);
+
+//! Solve an instance given in memory, precomputed for this solve only.
+//! \throw std::invalid_argument: if the instance is not a valid PDTSP instance.
+Result Solve(const InstanceData& instance, const Params& params, Callbacks& callbacks);
+
+}  // namespace pdtsp
+
+#endif  // PDTSP_H
@@ -0,0 +1,71 @@
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "hgsadc/hgsadc.h"
+#include "pdp/pdpinstance.h"
+#include "pdp/pdpsolution.h"
+#include "pdtsp_solvers.h"
+#include "utils/application.h"
+#include "utils/work.h"
+
+using namespace pdp;
+using namespace std;
+
+namespace pdtsp {
+
+Result SolveHGS(PDPInstance& instance, const Params& params, const vector<string>& args,
+                Callbacks& callbacks) {
+  // the instance is given in memory, the file name is only printed by --verbose
+  vector<string> arguments(args);
+  arguments.push_back("--instance=memory");
+  vector<char*> argv;
+  for (string& argument : arguments) argv.push_back(&argument[0]);
+
+  boost::program_options::variables_map variablesMap =
+      Application::initializeVariablesMap((int)argv.size(), argv.data());
+  std::srand((uint)variablesMap["seed"].as<int>());
+  Application::LoadArgs(variablesMap);
+
+  // the static state refers to the instance and to the callbacks of the caller, even if the solve throws
+  struct Cleanup {
+      ~Cleanup() {
+        Application::improvement = nullptr;
+        Application::initialRoutes.clear();
+        Application::instance = nullptr;
+      }
+  } cleanup;
+
+  // the distances and the closest customers are kept, the neighborhoods follow the options of the solve
+  Application::initialRoutes = params.initial;
+  Application::instance = &instance;
+  instance.Precompute();
+  Application::BeginSolve(&instance);
+
+  if (callbacks.improvement) {
+    Application::improvement = [&callbacks](const ga::Solution* solution) {
+      const PDPRoute& route = ((const PDPSolution*)solution)->route;
+      vector<int> visits(route.begin(), route.end());
+      callbacks.improvement(visits, solution->Cost(), Application::Ellapsed());
+    };
+  }
+
+  unique_ptr<ga::Solution> finalSolution(instance.CreateEmptySolution());
+  ga::HGSADC::Solve(finalSolution.get(), instance);
+
+  Result result;
+  const PDPRoute& route = ((PDPSolution*)finalSolution.get())->route;
+  result.route.assign(route.begin(), route.end());
+  result.cost = finalSolution->Cost();
+  result.time = Application::Ellapsed();
+  result.work = Work::Units();
+  result.educations = instance.Educations();
+  for (const Application::EvolutionEntry& entry : Application::evolution) {
+    result.evolution.push_back({entry.iteration, entry.time, entry.cost});
+  }
+  result.population = ga::HGSADC::population;
+  return result;
+}
+
+}  // namespace pdtsp
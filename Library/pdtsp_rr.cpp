@@ -0,0 +1,58 @@
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "application.h"
+#include "pdtsp_solvers.h"
+#include "solver.h"
+#include "utils/work.h"
+
+using namespace std;
+
+namespace pdtsp {
+
+Result SolveRR(const InstanceData& data, const Params& params, const vector<string>& args,
+               Callbacks& callbacks) {
+  vector<string> arguments(args);
+  vector<char*> argv;
+  for (string& argument : arguments) argv.push_back(&argument[0]);
+
+  boost::program_options::variables_map variablesMap =
+      rr::Application::initializeVariablesMap((int)argv.size(), argv.data());
+  std::srand((uint)variablesMap["seed"].as<int>());
+
+  rr::Instance::NodeList nodes;
+  for (size_t i = 0; i < data.nodes.size(); i++) {
+    rr::Instance::Node* node = new rr::Instance::Node();
+    node->idx = i;
+    node->x = data.nodes[i].x;
+    node->y = data.nodes[i].y;
+    node->pair = i > 0 ? data.nodes[i].pair : 0;
+    node->isPickup = i > 0 && data.nodes[i].isPickup;
+    node->isDelivery = i > 0 && !data.nodes[i].isPickup;
+    nodes.push_back(node);
+  }
+
+  Work::Reset();
+  rr::Solver solver(variablesMap, nodes, data.distances);
+  solver.initial = params.initial;
+  if (callbacks.improvement) {
+    solver.improvement = [&callbacks](const rr::Solution& solution, double time) {
+      callbacks.improvement(solution.visits, solution.cost, time);
+    };
+  }
+  solver.Solve();
+
+  Result result;
+  result.route = solver.Best().visits;
+  result.cost = solver.Best().cost;
+  result.time = rr::Application::Ellapsed();
+  result.work = Work::Units();
+  result.educations = solver.Iterations();
+  for (const rr::Solver::EvolutionEntry& entry : solver.Evolution()) {
+    result.evolution.push_back({entry.iteration, entry.time, entry.cost});
+  }
+  return result;
+}
+
+}  // namespace pdtsp
@@ -0,0 +1,46 @@
+/*MIT License
+ *
+Copyright(c) 2022 Toni Pacheco
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+#ifndef PDTSP_SOLVERS_H
+#define PDTSP_SOLVERS_H
+
+#include <string>
+#include <vector>
+
+#include "pdtsp.h"
+
+namespace pdtsp {
+
+//! Solve an instance with the HGS, building the neighborhoods of the parameters.
+//! \param instance: instance with its distances and closest customers (see pdtsp::Instance).
+//! \param args: pdphgs command line of the parameters.
+Result SolveHGS(pdp::PDPInstance& instance, const Params& params, const std::vector<std::string>& args,
+                Callbacks& callbacks);
+
+//! Solve a validated instance with the Ruin and Recreate.
+//! \param args: pdprr command line of the parameters.
+Result SolveRR(const InstanceData& instance, const Params& params, const std::vector<std::string>& args,
+               Callbacks& callbacks);
+
+}  // namespace pdtsp
+
+#endif  // PDTSP_SOLVERS_H
@@ -19,10 +19,21 @@ SOURCES += \
     pdp/pdprouteinfo.cpp \
     pdp/pdpsolution.cpp \
     utils/random.cpp \
+    utils/batch.cpp \
+    utils/server.cpp \
+    utils/checkpoint.cpp \
+    utils/threadpool.cpp \
+    utils/solutionfile.cpp \
+    utils/trace.cpp \
+    utils/work.cpp \
     utils/application.cpp \
+    utils/profiler.cpp \
     pdp/pdproute.cpp \
     pdp/pdpinstance.cpp \
+    pdp/pdpprecedenceindex.cpp \
     pdp/pdpeducate.cpp \
+    pdp/pdpscheduler.cpp \
+    pdp/pdpservice.cpp \
     pdp/moves/pdprelocatemove.cpp \
     pdp/moves/pdporoptmove.cpp \
     pdp/moves/pdpmoveevaluation.cpp \
@@ -45,10 +56,21 @@ HEADERS += \
     pdp/pdpnode.h \
     pdp/pdpsolution.h \
     utils/random.h \
+    utils/batch.h \
+    utils/server.h \
+    utils/checkpoint.h \
+    utils/threadpool.h \
+    utils/solutionfile.h \
+    utils/trace.h \
+    utils/work.h \
     utils/application.h \
+    utils/profiler.h \
     pdp/pdproute.h \
     pdp/pdpinstance.h \
+    pdp/pdpprecedenceindex.h \
     pdp/pdpeducate.h \
+    pdp/pdpscheduler.h \
+    pdp/pdpservice.h \
     pdp/moves/pdprelocatemove.h \
     pdp/moves/pdporoptmove.h \
     pdp/moves/pdpmoveevaluation.h \
@@ -70,6 +92,7 @@ LIBS += -lboost_program_options
 LIBS += -lboost_filesystem
 LIBS += -lboost_system
 LIBS += -lboost_regex
+LIBS += -lpthread
 
 QMAKE_CXXFLAGS += -std=c++0x
 
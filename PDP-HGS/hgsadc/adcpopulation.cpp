@@ -147,7 +147,7 @@ double ADCPopulation::AverageCost() const {
 }
 
 bool ADCPopulation::Add(Solution* s) {
-  Application::LogEvolution(s->Cost());
+  Application::LogEvolution(s);
 
   ///////////////GET POSITION/////////////
   size_t curSize = size();
@@ -260,6 +260,72 @@ void ADCPopulation::CalculateDC(Solution* solution, int nclosest) {
   solution->dc = distSum / nclosest;
 }
 
+void ADCPopulation::Save(Checkpoint::Data& data) const {
+  data.Put<int32_t>(nsz);
+  for (int i = 0; i < nsz; i++) {
+    data.Put<bool>(solutions[i] != nullptr);
+    if (solutions[i] == nullptr) continue;
+
+    data.PutVector(solutions[i]->Visits());
+    data.Put(solutions[i]->dc);
+    data.Put(solutions[i]->fitness);
+    data.Put(solutions[i]->isClone);
+  }
+
+  // free slots from the top of the stack
+  std::stack<int> free = freeSolutions;
+  data.Put<uint64_t>(free.size());
+  for (; !free.empty(); free.pop())
+    data.Put<int32_t>(free.top());
+
+  data.PutVector(std::vector<int>(rankingByCost, rankingByCost + nsz));
+  data.PutVector(std::vector<int>(rankingByDiversity, rankingByDiversity + nsz));
+  data.PutVector(std::vector<int>(rankingByDiversityAux, rankingByDiversityAux + nsz));
+  data.PutVector(std::vector<double>(maxDistance, maxDistance + nsz));
+  for (int i = 0; i < nsz; i++)
+    data.PutVector(std::vector<double>(distanceMatrix[i], distanceMatrix[i] + nsz));
+}
+
+void ADCPopulation::Restore(Checkpoint::Data& data) {
+  if (data.Get<int32_t>() != nsz) throw std::runtime_error("Checkpoint of other --mu or --lambda");
+
+  Keep(0);
+  for (int i = 0; i < nsz; i++) {
+    if (!data.Get<bool>()) continue;
+
+    solutions[i] = Application::instance->CreateSolution(data.GetVector<int>());
+    solutions[i]->idx = i;
+    solutions[i]->dc = data.Get<double>();
+    solutions[i]->fitness = data.Get<double>();
+    solutions[i]->isClone = data.Get<bool>();
+  }
+
+  std::vector<int> free(data.Get<uint64_t>());
+  for (int& idx : free)
+    idx = data.Get<int32_t>();
+  freeSolutions = std::stack<int>();
+  for (auto it = free.rbegin(); it != free.rend(); it++)
+    freeSolutions.push(*it);
+
+  std::vector<int> ranking = data.GetVector<int>();
+  std::vector<int> diversity = data.GetVector<int>();
+  std::vector<int> diversityAux = data.GetVector<int>();
+  std::vector<double> distances = data.GetVector<double>();
+  if (ranking.size() != (size_t)nsz || diversity.size() != (size_t)nsz ||
+      diversityAux.size() != (size_t)nsz || distances.size() != (size_t)nsz)
+    throw std::runtime_error("Corrupted checkpoint");
+  std::copy(ranking.begin(), ranking.end(), rankingByCost);
+  std::copy(diversity.begin(), diversity.end(), rankingByDiversity);
+  std::copy(diversityAux.begin(), diversityAux.end(), rankingByDiversityAux);
+  std::copy(distances.begin(), distances.end(), maxDistance);
+
+  for (int i = 0; i < nsz; i++) {
+    distances = data.GetVector<double>();
+    if (distances.size() != (size_t)nsz) throw std::runtime_error("Corrupted checkpoint");
+    std::copy(distances.begin(), distances.end(), distanceMatrix[i]);
+  }
+}
+
 const Solution* ADCPopulation::BestSolution() const {
   return (*this)[0];
 }
@@ -28,6 +28,7 @@ SOFTWARE.*/
 #include <stack>
 
 #include "hgsadc/solution.h"
+#include "utils/checkpoint.h"
 
 namespace ga {
 class ADCPopulation {
@@ -51,6 +52,13 @@ class ADCPopulation {
     double AverageCost() const;
     double AverageDC() const;
 
+    //! Write the individuals, rankings and distances (checkpoint).
+    void Save(Checkpoint::Data& data) const;
+
+    //! Replace the population by a saved one.
+    //! \throw std::runtime_error: if the population was saved with other sizes.
+    void Restore(Checkpoint::Data& data);
+
   private:
     inline Solution* at(size_t pos) const;
     double Distance(int s1, int s2) const;
@@ -5,13 +5,19 @@
 
 #include "hgsadc/adcpopulation.h"
 #include "utils/application.h"
+#include "utils/checkpoint.h"
 #include "utils/random.h"
+#include "utils/trace.h"
+#include "utils/work.h"
 
 using namespace std;
 #include <iomanip>
 
 namespace ga {
 
+Profile HGSADC::profiles[HGSADC::PHASES];
+std::vector<std::vector<int> > HGSADC::population;
+
 HGSADC::HGSADC() {
 }
 int countAll = 0;
@@ -27,6 +33,7 @@ void HGSADC::SelectParents(const ADCPopulation& population, Solution*& p1, Solut
 }
 
 void HGSADC::DiversifyPopulation(ADCPopulation& population, const int numberOfIndividuals) {
+  Trace::Span span("DiversifyPopulation");
   population.Keep(Application::hgsadc_populationSize / 3);
 
   for (int i = 0; i < numberOfIndividuals; i++) {
@@ -48,8 +55,26 @@ void HGSADC::DiversifyPopulation(ADCPopulation& population, const int numberOfIn
 }
 
 void HGSADC::InitializePopulation(ADCPopulation& population, const int numberOfIndividuals) {
+  Trace::Span span("InitializePopulation");
   population.Keep(0);
-  for (int i = 0; i < numberOfIndividuals; i++) {
+
+  // warm start: the given solutions, then a share of the random individuals
+  int randomIndividuals = numberOfIndividuals;
+  if (!Application::initialRoutes.empty()) {
+    for (const std::vector<int>& visits : Application::initialRoutes) {
+      Solution* s;
+      if (Application::initial_local) {
+        s = Application::instance->CreateUpdatedSolution(visits);
+      } else {
+        s = Application::instance->CreateSolution(visits);
+        Application::instance->Educate(s);
+      }
+      population.Add(s);
+    }
+    randomIndividuals = (int)(numberOfIndividuals * Application::initial_fill + 0.5);
+  }
+
+  for (int i = 0; i < randomIndividuals; i++) {
     Solution* s = Application::instance->CreateRandomSolution();
 
     Solution* s2 = s->Clone();
@@ -91,6 +116,92 @@ void PrintGenerationLog(Problem& problem, Solution* best, ADCPopulation& populat
   }
 }
 
+namespace {
+
+//! Search state between two iterations, enough to continue the run as if it was not interrupted.
+struct SearchState {
+    int iterationsCount;
+    int generationCount;
+    int iterationsWithoutImprovement;
+};
+
+//! Identity of the runs a snapshot can continue.
+struct Fingerprint {
+    //! hash of the sizes of the structures saved byte for byte, which depend on the build.
+    uint64_t layout;
+
+    //! hash of the instance (see Problem::Hash).
+    uint64_t instance;
+
+    //! hash of the search options (see Application::searchOptions).
+    uint64_t options;
+};
+
+Fingerprint Identify(const Problem& problem) {
+  Fingerprint fingerprint;
+  const size_t sizes[] = {sizeof(size_t), sizeof(double), sizeof(SearchState),
+                          sizeof(Application::EvolutionEntry)};
+  fingerprint.layout = Checkpoint::Data::Hash(sizes, sizeof(sizes));
+
+  fingerprint.instance = problem.Hash();
+
+  const std::string& options = Application::searchOptions;
+  fingerprint.options = Checkpoint::Data::Hash(options.data(), options.size());
+  return fingerprint;
+}
+
+Checkpoint::Data Snapshot(const Fingerprint& fingerprint, const SearchState& state, const Solution* best,
+                          const ADCPopulation& population, const Problem& problem) {
+  Checkpoint::Data data;
+  data.Put(fingerprint);
+  data.Put(Application::Ellapsed());
+  data.Put(Application::WallEllapsed());
+  data.Put<uint64_t>(Work::Units());
+  data.PutString(Random::State());
+  data.Put(state);
+
+  data.Put<uint64_t>(Application::evolutionCount);
+  data.Put(Application::bestCost);
+  data.PutVector(Application::evolution);
+
+  data.PutVector(problem.LSState());
+  data.PutString(problem.SchedulerState());
+  data.PutVector(best->Visits());
+  population.Save(data);
+  return data;
+}
+
+void Restore(const Fingerprint& fingerprint, Checkpoint::Data& data, SearchState& state, Solution* best,
+             ADCPopulation& population, Problem& problem) {
+  Fingerprint saved = data.Get<Fingerprint>();
+  if (saved.layout != fingerprint.layout) throw std::runtime_error("Checkpoint of another build");
+  if (saved.instance != fingerprint.instance) throw std::runtime_error("Checkpoint of another instance");
+  if (saved.options != fingerprint.options) throw std::runtime_error("Checkpoint of other search options");
+  Application::startTime = clock() - (clock_t)(data.Get<double>() * CLOCKS_PER_SEC);
+  Application::wallStartTime = std::chrono::steady_clock::now() -
+                               std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                   std::chrono::duration<double>(data.Get<double>()));
+  Work::Restore(data.Get<uint64_t>());
+  std::string random = data.GetString();
+  state = data.Get<SearchState>();
+
+  Application::evolutionCount = data.Get<uint64_t>();
+  Application::bestCost = data.Get<double>();
+  Application::evolution = data.GetVector<Application::EvolutionEntry>();
+
+  problem.RestoreLSState(data.GetVector<size_t>());
+  problem.RestoreSchedulerState(data.GetString());
+  Solution* solution = problem.CreateSolution(data.GetVector<int>());
+  *best = *solution;
+  delete solution;
+  population.Restore(data);
+
+  // last, as rebuilding the solutions may draw random numbers
+  Random::SetState(random);
+}
+
+}  // namespace
+
 void HGSADC::Solve(Solution* best, Problem& problem) {
   int iterationsCount = 0;
   int generationCount = 1;
@@ -100,16 +211,38 @@ void HGSADC::Solve(Solution* best, Problem& problem) {
   oldState.copyfmt(std::cout);
 
   ADCPopulation population;
+  Fingerprint fingerprint = {0, 0, 0};
+  bool checkpoints = !Application::resumeFile.empty() || !Application::checkpointFile.empty();
+  if (checkpoints) fingerprint = Identify(problem);
 
   if (Application::verbose) {
     std::cout << "\t=> METHOD: HGSADC" << endl;
   }
 
-  InitializePopulation(population, Application::hgsadc_populationSize * 4);
-  *best = *population.BestSolution();
+  if (Application::resumeFile.empty()) {
+    InitializePopulation(population, Application::hgsadc_populationSize * 4);
+    *best = *population.BestSolution();
+  } else {
+    SearchState state;
+    Checkpoint::Data data = Checkpoint::Read(Application::resumeFile);
+    Restore(fingerprint, data, state, best, population, problem);
+    iterationsCount = state.iterationsCount;
+    generationCount = state.generationCount;
+    iterationsWithoutImprovement = state.iterationsWithoutImprovement;
+  }
 
+  Checkpoint* checkpoint = nullptr;
+  if (!Application::checkpointFile.empty())
+    checkpoint = new Checkpoint(Application::checkpointFile, Application::checkpoint_every);
+
+  int64_t generationStart = Trace::Start();
   while (iterationsWithoutImprovement < Application::hgsadc_maxIterationsWithoutImprovement &&
          !Application::Timeout()) {
+    if (checkpoint && checkpoint->Due()) {
+      SearchState state = {iterationsCount, generationCount, iterationsWithoutImprovement};
+      checkpoint->Write(Snapshot(fingerprint, state, best, population, problem));
+    }
+
     if (iterationsCount % Application::hgsadc_offspringInGeneration == 0) {
       PrintGenerationLog(problem, best, population, generationCount, iterationsWithoutImprovement, false);
     }
@@ -122,17 +255,34 @@ void HGSADC::Solve(Solution* best, Problem& problem) {
     SelectParents(population, p1, p2);
     Solution* child = Application::instance->CreateEmptySolution();
 
+    int64_t profileStart = Profile::Start();
     problem.Crossover(child, p1, p2);
+    profiles[CROSSOVER].Stop(profileStart);
+
+    profileStart = Profile::Start();
     problem.Mutate(child);
+    profiles[MUTATE].Stop(profileStart);
+
+    profileStart = Profile::Start();
     problem.Repair(child);
+    profiles[REPAIR].Stop(profileStart);
+
+    profileStart = Profile::Start();
+    double childCost = child->Cost();
     problem.Educate(child);
+    profiles[EDUCATE].Stop(profileStart, childCost - child->Cost());
 
     // UPDATE POPULATION
     bool updateBest = *child < *best;
+    profileStart = Profile::Start();
     population.Add(child);
+    profiles[ADD].Stop(profileStart);
     if ((iterationsCount % Application::hgsadc_offspringInGeneration) == 0) {
       SelectSurvivors(population);
       generationCount++;
+
+      Trace::Stop("Generation", generationStart);
+      generationStart = Trace::Start();
     }
 
     if (updateBest) {
@@ -153,11 +303,33 @@ void HGSADC::Solve(Solution* best, Problem& problem) {
     }
   }
 
+  Trace::Stop("Generation", generationStart);
+
+  if (checkpoint) {
+    SearchState state = {iterationsCount, generationCount, iterationsWithoutImprovement};
+    checkpoint->Write(Snapshot(fingerprint, state, best, population, problem));
+    delete checkpoint;
+  }
+
   // FINAL INFORMATIONS
   SelectSurvivors(population);
   PrintGenerationLog(problem, best, population, generationCount, iterationsWithoutImprovement, true);
 
+  HGSADC::population.clear();
+  for (size_t i = 0; i < population.size(); i++)
+    HGSADC::population.push_back(population[i]->Visits());
+
   std::cout.copyfmt(oldState);
 }
 
+std::string HGSADC::ProfileLog() {
+  static const char* names[] = {"crossover", "mutate", "repair", "educate", "add"};
+
+  std::string s = "{";
+  for (int phase = 0; phase < PHASES; phase++) {
+    s += std::string(phase ? ",\t      \"" : "\t      \"") + names[phase] + "\": " + profiles[phase].Json();
+  }
+  return s + "\t    }";
+}
+
 }  // namespace ga
@@ -23,9 +23,12 @@ SOFTWARE.*/
 #ifndef HGSADC_H
 #define HGSADC_H
 
+#include <vector>
+
 #include "hgsadc/adcpopulation.h"
 #include "hgsadc/problem.h"
 #include "hgsadc/solution.h"
+#include "utils/profiler.h"
 
 namespace ga {
 
@@ -36,6 +39,15 @@ class HGSADC {
   public:
     static void Solve(Solution* s, Problem& problem);
 
+    //! Get the profile of the offspring generation phases as a JSON object (--profile).
+    static std::string ProfileLog();
+
+    //! Visit orders of the population when the last solve ended, the best first (re-planning).
+    static std::vector<std::vector<int> > population;
+
+    //! Offspring generation phases.
+    enum Phase { CROSSOVER = 0, MUTATE, REPAIR, EDUCATE, ADD, PHASES };
+
   protected:
     static void SelectParents(const ADCPopulation& population, Solution*& p1, Solution*& p2);
 
@@ -44,6 +56,9 @@ class HGSADC {
     static void DiversifyPopulation(ADCPopulation& population, const int numberOfIndividuals);
 
     static void SelectSurvivors(ADCPopulation& population);
+
+    //! Profile of each offspring generation phase, the educate gain being the child cost decrease.
+    static Profile profiles[PHASES];
 };
 
 }  // namespace ga
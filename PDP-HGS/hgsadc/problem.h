@@ -23,7 +23,10 @@ SOFTWARE.*/
 #ifndef PROBLEM_H
 #define PROBLEM_H
 
+#include <stdint.h>
+
 #include <string>
+#include <vector>
 
 #include "hgsadc/solution.h"
 
@@ -56,12 +59,44 @@ class Problem {
 
     virtual void* Data() = 0;
     virtual void Precompute() = 0;
+
+    //! Check if the instance is precomputed (see Precompute).
+    virtual bool Precomputed() const = 0;
+
+    //! Hash of the instance (distances and requests), identifying the instance of a checkpoint.
+    virtual uint64_t Hash() const = 0;
+
     virtual size_t Size() const = 0;
 
     virtual ga::Solution* CreateRandomSolution() const = 0;
     virtual ga::Solution* CreateEmptySolution() const = 0;
 
+    //! Create a solution from a given visit order (warm start), repaired to visit every customer.
+    //! \param visits: customers in visit order, possibly incomplete or infeasible.
+    virtual ga::Solution* CreateSolution(const std::vector<int>& visits) = 0;
+
+    //! Create an educated solution from a local optimum missing some requests (e.g. a route of a previous
+    //! plan, re-planning): they are inserted as by CreateSolution, and only the route around them is
+    //! educated.
+    //! \param visits: customers in visit order, a local optimum but for the missing requests.
+    virtual ga::Solution* CreateUpdatedSolution(const std::vector<int>& visits) = 0;
+
+    //! Get the local search state carried from an education to the next (checkpoint).
+    virtual std::vector<size_t> LSState() const = 0;
+
+    //! Restore a local search state got from LSState.
+    //! \throw std::runtime_error: if the state belongs to other neighborhoods or instance.
+    virtual void RestoreLSState(const std::vector<size_t>& state) = 0;
+
+    //! Get the state of the adaptive neighborhood scheduler (checkpoint).
+    virtual std::string SchedulerState() const = 0;
+
+    //! Restore a scheduler state got from SchedulerState.
+    //! \throw std::runtime_error: if the state belongs to other neighborhoods or options.
+    virtual void RestoreSchedulerState(const std::string& state) = 0;
+
     virtual std::string LSCompleteLog() = 0;
+    virtual std::string ProfileLog() = 0;
     virtual std::string LSLog() = 0;
     virtual void LSLogReset() = 0;
 
@@ -24,6 +24,7 @@ SOFTWARE.*/
 #define GA_SOLUTION_H
 
 #include <iostream>
+#include <vector>
 
 namespace ga {
 
@@ -41,6 +42,9 @@ class Solution {
     //! Print solution state
     virtual void Print(std::ostream& os = std::cout) const = 0;
 
+    //! Get the customers in visit order, as given to Problem::CreateSolution.
+    virtual std::vector<int> Visits() const = 0;
+
     bool operator<(const Solution& s) const {
       return this->Cost() < s.Cost();
     }
@@ -1,11 +1,18 @@
 #include <limits.h>
 
 #include <iostream>
+#include <sstream>
 
 #include "hgsadc/hgsadc.h"
 #include "pdp/pdpinstance.h"
+#include "pdp/pdpservice.h"
+#include "pdp/pdpsolution.h"
 #include "utils/application.h"
+#include "utils/batch.h"
+#include "utils/profiler.h"
 #include "utils/random.h"
+#include "utils/solutionfile.h"
+#include "utils/work.h"
 
 using namespace pdp;
 using namespace std;
@@ -22,26 +29,89 @@ using namespace std;
 --verbose
 */
 
+//! Solve an instance of a batch, in its worker process.
+//! \param instanceFile: instance file path.
+//! \return string: result as a JSON line.
+string SolveBatchInstance(const string& instanceFile) {
+  Application::instanceFile = instanceFile;
+  Application::BeginSolve(PDPInstance::fromFilePath(instanceFile));
+
+  ga::Solution* finalSolution = Application::instance->CreateEmptySolution();
+  ga::HGSADC::Solve(finalSolution, *Application::instance);
+
+  ostringstream line;
+  line << "{\"instance\": " << Batch::Quote(instanceFile);
+  line << ", \"cost\": " << finalSolution->Cost();
+  line << ", \"time\": " << Application::Ellapsed();
+  line << ", \"work\": " << Work::Units();
+  line << ", \"feasible\": " << (finalSolution->IsFeasible() ? "true" : "false");
+  line << ", \"solution\": ";
+  ((PDPSolution*)finalSolution)->route.Print(line);
+  line << "}";
+
+  delete Application::instance;
+  delete finalSolution;
+  return line.str();
+}
+
 int main(int argc, char* argv[]) {
   boost::program_options::variables_map variablesMap = Application::initializeVariablesMap(argc, argv);
 
   uint seed = (uint)variablesMap["seed"].as<int>();
   std::srand(seed);
 
-  // solve only one instance specified by the --instance cmdline argument
-  if (variablesMap["instance"].empty()) {
+  // solve only one instance specified by the --instance cmdline argument, a --batch of instances, or the
+  // requests of a --serve daemon
+  bool batch = !variablesMap["batch"].as<string>().empty();
+  bool serve = !variablesMap["serve"].as<string>().empty();
+  if (variablesMap["instance"].empty() && !batch && !serve) {
     cout << "No input instance. Use --help for more information" << endl;
     exit(1);
   }
+  if ((batch || serve) && !variablesMap["trace"].as<string>().empty()) {
+    cout << "--trace records a single run and cannot be used with --batch or --serve" << endl;
+    exit(1);
+  }
+  if ((batch || serve) &&
+      (!variablesMap["checkpoint"].as<string>().empty() || !variablesMap["resume"].as<string>().empty())) {
+    cout << "--checkpoint and --resume snapshot a single run and cannot be used with --batch or --serve"
+         << endl;
+    exit(1);
+  }
 
   Application::LoadArgs(variablesMap);
 
+  // warm start
+  for (const string& file : Application::initialFiles) {
+    try {
+      Application::initialRoutes.push_back(SolutionFile::Read(file));
+    } catch (const std::exception& e) {
+      cout << e.what() << endl;
+      exit(1);
+    }
+  }
+
+  // each instance is solved with the --it, --time-limit and --work-limit budgets of the command line
+  if (batch) {
+    vector<string> instances = Batch::Instances(Application::batchPath);
+    if (instances.empty()) {
+      cout << "No instance found in " << Application::batchPath << endl;
+      exit(1);
+    }
+    return Batch::Run(instances, Application::batch_jobs, SolveBatchInstance);
+  }
+
+  if (serve) {
+    PDPService service(Application::serve_cache);
+    return Server::Serve(Application::servePath, Application::serve_jobs,
+                         [&service](const string& request, const string& prepared, string& response,
+                                    bool& preparing) {
+                           return service.Handle(request, prepared, response, preparing);
+                         });
+  }
+
   // load instance file
-  Application::instance = PDPInstance::fromFilePath(Application::instanceFile);
-  Application::instance->Precompute();
-  Application::startTime = clock();
-  Application::evolution.clear();
-  Application::bestCost = FLT_MAX;
+  Application::BeginSolve(PDPInstance::fromFilePath(Application::instanceFile));
 
   if (Application::verbose) {
     std::cout << "RUN LOG START:" << endl << endl;
@@ -85,12 +155,19 @@ int main(int argc, char* argv[]) {
   }
 
   ga::Solution* finalSolution = Application::instance->CreateEmptySolution();
-  ga::HGSADC::Solve(finalSolution, *Application::instance);  // execute solver
+  try {
+    ga::HGSADC::Solve(finalSolution, *Application::instance);  // execute solver
+  } catch (const std::runtime_error& e) {
+    cout << e.what() << endl;
+    exit(1);
+  }
 
   if (Application::verbose) {
     std::cout << endl << endl << "SEARCH STATS:" << endl << endl;
     std::cout << "\tCOST: " << finalSolution->Cost() << endl;
     std::cout << "\tTIME: " << Application::Ellapsed() << "s" << endl;
+    std::cout << "\tWORK: " << Work::Units() << " (" << Work::PerSecond(Application::Ellapsed()) << "/s)"
+              << endl;
     std::cout << "\tLOCAL SEARCH: " << Application::instance->LSCompleteLog() << endl;
     std::cout << endl << endl << "SOLUTION LOG:" << endl << endl;
 
@@ -103,10 +180,19 @@ int main(int argc, char* argv[]) {
     std::cout << "  \"version\": \"" << STRINGIZE_VALUE_OF(BUILD_PDP_VERSION) << "\"," << endl;
     std::cout << "  \"cost\": " << finalSolution->Cost() << "," << endl;
     std::cout << "  \"time\": " << Application::Ellapsed() << "," << endl;
+    std::cout << "  \"work\": " << Work::Units() << "," << endl;
+    std::cout << "  \"work_per_s\": " << Work::PerSecond(Application::Ellapsed()) << "," << endl;
     std::string ls_log = Application::instance->LSCompleteLog();
     std::replace(ls_log.begin(), ls_log.end(), '\t', '\n');
     std::cout << ls_log << "," << endl;
 
+    if (Profile::enabled) {
+      std::string profile = "  \"profile\": {\t    \"neighborhoods\": " + Application::instance->ProfileLog() +
+                            ",\t    \"hgsadc\": " + ga::HGSADC::ProfileLog() + "\t  }";
+      std::replace(profile.begin(), profile.end(), '\t', '\n');
+      std::cout << profile << "," << endl;
+    }
+
     finalSolution->Print();
     std::cout << "," << endl;
     std::cout << "  \"evolution\": [" << endl;
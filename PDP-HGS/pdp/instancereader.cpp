@@ -134,7 +134,7 @@ PDPInstance* InstanceReaderGrubhub::fromFile(const string instanceFilePath) {
 
   PDPInstance* instance = new PDPInstance(std::max(Application::hgsadc_cl, 1), nodelist, "");
 
-  double**& distances = Application::instance->Distances();
+  double**& distances = instance->Distances();
   distances = new double*[numberOfNodes];
 
   for (int i = 0; i < numberOfNodes; i++) {
@@ -151,6 +151,7 @@ PDPInstance* InstanceReaderGrubhub::fromFile(const string instanceFilePath) {
     }
   }
 
+  instance->euclidean = false;
   return instance;
 }
 
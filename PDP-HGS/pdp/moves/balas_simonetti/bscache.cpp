@@ -17,11 +17,89 @@
 
 #include "bscache.h"
 
+#include <string.h>
+
 #include <algorithm>
 
-/**
- * Returns true if *a* has higher usage than *b* and false otherwise
- */
-bool BSCache::higherUsage(const BSCache *a, const BSCache *b) {
-  return a->usage > b->usage;
+BSCache::BSCache(size_t maxMemory, int maxLength)
+    : queries(0), hits(0), improvements(0), evictions(0), collisions(0), nUsed(0), hand(0) {
+  entrySize = sizeof(BSCacheEntry) + sizeof(int) * ((maxLength + 1) & ~1);
+
+  // the table has between 2 and 4 slots per entry
+  nEntries = std::max((size_t)1, maxMemory / (entrySize + 4 * sizeof(int)));
+  size_t tableSize = 1;
+  while (tableSize < 2 * nEntries)
+    tableSize <<= 1;
+  mask = tableSize - 1;
+
+  arena = new char[nEntries * entrySize];
+  table = new int[tableSize];
+  memset(table, -1, sizeof(int) * tableSize);
+}
+
+BSCache::~BSCache() {
+  delete[] arena;
+  delete[] table;
+}
+
+BSCacheEntry *BSCache::find(const BSSetHash &setHash) const {
+  for (size_t i = home(setHash.setHash, setHash.setHashRev, setHash.size); table[i] >= 0; i = (i + 1) & mask) {
+    BSCacheEntry *element = entry(table[i]);
+    if (element->matches(setHash)) return element;
+  }
+  return nullptr;
+}
+
+BSCacheEntry *BSCache::insert(const BSSetHash &setHash) {
+  size_t index;
+  if (nUsed < nEntries) {
+    index = nUsed++;
+  } else {
+    // CLOCK: clears the reference bits until finding an entry without a second chance
+    while (entry(hand)->referenced) {
+      entry(hand)->referenced = 0;
+      hand = (hand + 1) % nEntries;
+    }
+    index = hand;
+    hand = (hand + 1) % nEntries;
+    if (entry(index)->size >= 0) {
+      erase(entry(index));
+      evictions++;
+    }
+  }
+
+  BSCacheEntry *element = entry(index);
+  element->setHash = setHash.setHash;
+  element->setHashRev = setHash.setHashRev;
+  element->size = setHash.size;
+  element->referenced = 0;
+  element->nextRoute = 0;
+  std::fill(element->routes, element->routes + BS_CACHE_ROUTES, (size_t)0);
+
+  size_t i = home(setHash.setHash, setHash.setHashRev, setHash.size);
+  while (table[i] >= 0)
+    i = (i + 1) & mask;
+  table[i] = (int)index;
+
+  return element;
+}
+
+void BSCache::erase(BSCacheEntry *element) {
+  int index = (int)(((char *)element - arena) / entrySize);
+  size_t i = home(element->setHash, element->setHashRev, element->size);
+  while (table[i] != index)
+    i = (i + 1) & mask;
+  element->size = -1;
+  element->referenced = 0;
+
+  // backward-shift deletion: moves back the entries whose probe sequence passed by slot i
+  for (size_t j = (i + 1) & mask; table[j] >= 0; j = (j + 1) & mask) {
+    BSCacheEntry *moved = entry(table[j]);
+    size_t k = home(moved->setHash, moved->setHashRev, moved->size);
+    if (((j - k) & mask) >= ((j - i) & mask)) {
+      table[i] = table[j];
+      i = j;
+    }
+  }
+  table[i] = -1;
 }
@@ -143,145 +143,124 @@ struct BSHash {
 };
 
 /*===========================================================================*/
-// BSCache class
+// BSCacheEntry class
 /*===========================================================================*/
 
-#ifdef NO_TUNNELING
+/// number of route hashes (input sequences) remembered per cached set
+#define BS_CACHE_ROUTES 4
 
-class BSCache {
+/**
+ * Entry of the BSCache. Entries are stored inline in the cache arena, each one
+ * immediately followed by its (optimized) sequence.
+ */
+struct BSCacheEntry {
   public:
-    /***
-     * Constructor for a BSCache
-     *
-     * @param hashCode hash code of the input sequence
-     */
-    BSCache(const BSHash hash) : hash(hash), usage(0) {
-      sequence = nullptr;
-    }
+    /// hash code of the set (size < 0 marks a free entry)
+    size_t setHash, setHashRev;
+    int size;
 
-    ~BSCache() {
-      if (sequence != nullptr) delete[] sequence;
-    }
+    /// CLOCK reference bit
+    int referenced;
 
-    inline bool operator<(const BSCache& cache) const {
-      return usage < cache.usage;
-    }
+    /// optimized distance (of the cached path, endpoints included)
+    double distance;
 
-    inline BSHash getHash() const {
-      return hash;
+    /// hash codes of the last routes (sequences) that led to this entry
+    size_t routes[BS_CACHE_ROUTES];
+    int nextRoute;
+
+    inline bool matches(const BSSetHash& hash) const {
+      return setHash == hash.setHash && setHashRev == hash.setHashRev && size == hash.size;
     }
 
-    inline size_t memorySize() const {
-      return sizeof(BSCache)                                         // this structure' memory plus
-             + sizeof(BSCache*) + sizeof(BSSetHash) + sizeof(void*)  // memory used within the main cache
-             + sizeof(int) * hash.setHash.size;                      // sequence memory
+    inline bool has(const BSRouteHash& routeHash) const {
+      for (int i = 0; i < BS_CACHE_ROUTES; i++)
+        if (routes[i] == routeHash.routeHash) return true;
+      return false;
     }
 
-    /// hash code of the set
-    const BSHash hash;
+    inline void insert(const BSRouteHash& routeHash) {
+      if (has(routeHash)) return;
+      routes[nextRoute] = routeHash.routeHash;
+      nextRoute = (nextRoute + 1) % BS_CACHE_ROUTES;
+    }
 
     /// optimized (cached) sequence
-    int* sequence;
-
-    /// optimized distance
-    double distance;
-
-    /// position in the vector for O(1) removal
-    size_t index;
-
-    /// number of times this cache element was used
-    size_t usage;
-
-    /**
-     * Returns true if b1 has higher usage than b2 and false otherwise
-     */
-    static bool higherUsage(const BSCache* b1, const BSCache* b2);
-
-    /**
-     * Runs tests with the BSCache (to check collisions, for example)
-     */
-    static int runTest(int argc, char* argv[]);
+    inline int* sequence() {
+      return reinterpret_cast<int*>(this + 1);
+    }
 };
 
-#else
+/*===========================================================================*/
+// BSCache class
+/*===========================================================================*/
 
+/**
+ * Fixed-capacity cache of optimized sequences, indexed by the set of customers.
+ * The entries live in a single arena allocated up-front and are addressed by an
+ * open-addressing (linear probing) table; when the arena is full, the entry to
+ * replace is chosen with the CLOCK (second-chance) policy.
+ */
 class BSCache {
   public:
     /***
      * Constructor for a BSCache
      *
-     * @param hashCode hash code of the input sequence
+     * @param maxMemory memory (in bytes) used by the arena and the table
+     * @param maxLength maximum length of a cached sequence
      */
-    BSCache(const BSSetHash setHash) : setHash(setHash), usage(0) {
-      sequence = nullptr;
-    }
-
-    ~BSCache() {
-      if (sequence != nullptr) delete[] sequence;
-    }
+    BSCache(size_t maxMemory, int maxLength);
 
-    inline bool operator<(const BSCache& cache) const {
-      return usage < cache.usage;
-    }
+    ~BSCache();
 
-    inline BSSetHash getHash() const {
-      return setHash;
-    }
-
-    inline bool has(const BSRouteHash& routeHash) const {
-      return routes.count(routeHash) > 0;
-    }
+    /**
+     * Returns the entry of a set of customers, or nullptr if it is not cached.
+     */
+    BSCacheEntry* find(const BSSetHash& setHash) const;
 
-    inline void insert(const BSRouteHash& routeHash) {
-      routes.insert(routeHash);
-      usage++;
-    }
+    /**
+     * Creates the entry of a set of customers (which must not be cached),
+     * evicting another entry if the cache is full.
+     */
+    BSCacheEntry* insert(const BSSetHash& setHash);
 
-    inline size_t memorySize() const {
-      return sizeof(BSCache)                                         // this structure' memory plus
-             + sizeof(BSCache*) + sizeof(BSSetHash) + sizeof(void*)  // memory used within the main cache
-             + sizeof(int) * this->setHash.size                      // sequence memory
-             + (sizeof(void*) + sizeof(BSRouteHash) + sizeof(BSRouteHash)) *
-                   this->routes.size()                         // permutations' memory
-             + (sizeof(void*)) * this->routes.bucket_count();  // unordered_set internal memory
-    }
+    /**
+     * Removes an entry from the cache.
+     */
+    void erase(BSCacheEntry* entry);
 
-    inline size_t size() const {
-      return routes.size();
+    /// number of entries the cache may hold
+    inline size_t capacity() const {
+      return nEntries;
     }
 
-    /// hash code of the set
-    const BSSetHash setHash;
+    /// basic usage statistics
+    size_t queries, hits, improvements, evictions, collisions;
 
-    /// hash codes of the routes (sequences)
-    std::unordered_set<BSRouteHash, BSRouteHash> routes;
+  private:
+    /// arena with the entries (each one followed by its sequence)
+    char* arena;
 
-    /// original sequence (for debugging purposes only)
-    // std::vector<int> originalSequence;
+    /// open-addressing table with the indices of the entries (-1 if empty)
+    int* table;
 
-    /// optimized (cached) sequence
-    int* sequence;
-
-    /// optimized distance
-    double distance;
+    /// size (in bytes) of an entry and its sequence
+    size_t entrySize;
 
-    /// position in the vector for O(1) removal
-    size_t index;
+    /// number of entries, number of entries ever used and CLOCK hand
+    size_t nEntries, nUsed, hand;
 
-    /// number of times this cache element was used
-    size_t usage;
+    /// table size minus one (the table size is a power of two)
+    size_t mask;
 
-    /**
-     * Returns true if b1 has higher usage than b2 and false otherwise
-     */
-    static bool higherUsage(const BSCache* b1, const BSCache* b2);
+    inline BSCacheEntry* entry(size_t index) const {
+      return reinterpret_cast<BSCacheEntry*>(arena + index * entrySize);
+    }
 
-    /**
-     * Runs tests with the BSCache (to check collisions, for example)
-     */
-    static int runTest(int argc, char* argv[]);
+    inline size_t home(size_t setHash, size_t setHashRev, int size) const {
+      size_t h = (setHash ^ (setHashRev * 0x9E3779B97F4A7C15ULL) ^ (size_t)size) * 0xFF51AFD7ED558CCDULL;
+      return (h ^ (h >> 29)) & mask;
+    }
 };
 
-#endif  // BSCache
-
 #endif  // BSCACHE_H
@@ -28,15 +28,15 @@
 #include "pdp/pdpnode.h"
 #include "pdp/pdproute.h"
 #include "utils/application.h"
+#include "utils/threadpool.h"
+#include "utils/work.h"
 
 using namespace pdp;
 using namespace std;
 
 // temporary (debugging) stuff...
 #define BSGRAPH_DEBUG 0
-#define CACHE_MAX 60000011
-#define CACHE_OCCUPATION 0.8
-#define CACHE_RESULTS 0
+#define BS_BLOCK_SIZE 64
 
 // initializing singleton object to null
 BSGraph *BSGraph::singleton = nullptr;
@@ -141,8 +141,6 @@ BSGraph::BSGraph(unsigned int k, unsigned int nLocations, double **distMatrix, c
   this->nEdges = 0;
   this->nLocations = nLocations;
 
-  this->result_vec.resize(nLocations + 2);
-
   // printf("Creating Ballas&Simonetti heuristic with k=%u for %d locations.\n",
   // k, nLocations); printf("    Cache maximum memory: %.0fMb\n\n", (double)
   // maxMemory / 1e6);
@@ -155,8 +153,7 @@ BSGraph::BSGraph(unsigned int k, unsigned int nLocations, double **distMatrix, c
   preProcessLayers();
 
   // initializing auxiliary structures
-  prevDists = new double[nodes.size()];
-  dists = new double[nodes.size()];
+  initWorkspace(workspace);
 
   // initializing (and caching) multipliers (for faster hash computation)
   hashMultiplier =
@@ -176,21 +173,8 @@ BSGraph::BSGraph(unsigned int k, unsigned int nLocations, double **distMatrix, c
   for (uint i = 1; i < nLocations + 1; i++)
     cachedHashCodesRev[i] = (cachedHashCodesRev[i - 1] * 31 + (i + 1));  // % BIG_PRIME;
 
-  if (CACHE_RESULTS) {
-    // allocating space and resetting cache counters
-    cacheMemoryUsage = 0;
-    cache.reserve(CACHE_MAX);
-    cacheVector.reserve((size_t)ceil(CACHE_MAX * CACHE_OCCUPATION) + 1);
-    cacheQueries = 0;
-    cacheCleanUps = 0;
-    cacheImprovement = 0;
-    cacheSideways = 0;
-    cacheRemoval = 0;
-    cacheCollisions = 0;
-
-    cacheMemoryUsage = sizeof(void *) * cache.bucket_count()       // cache size
-                       + sizeof(void *) * cacheVector.capacity();  // cacheVector size
-  }
+  // allocating the (fixed-size) cache of optimized sequences
+  cache = maxMemory > 0 ? new BSCache(maxMemory, nLocations + 2) : nullptr;
 
   if (BSGRAPH_DEBUG) {
     // printing number of nodes (simple check)
@@ -215,35 +199,6 @@ BSGraph::BSGraph(unsigned int k, unsigned int nLocations, double **distMatrix, c
   singleton = this;
 }
 
-void BSGraph::clearCache() {
-  if (cacheVector.size() < CACHE_MAX * CACHE_OCCUPATION && cacheMemoryUsage < maxMemory) return;
-
-  clock_t start = clock();
-  printf("cleaning cache (~%.2f gb used)...\n", (double)cacheMemoryUsage / 1e9);
-  assert(CACHE_RESULTS);
-  cacheCleanUps++;
-
-  size_t newSize = cacheVector.size() / 2;
-  nth_element(cacheVector.begin(), cacheVector.begin() + newSize, cacheVector.end(), BSCache::higherUsage);
-
-  // important: all elements after newSize have usage <= the median and should
-  // be removed
-  while (cacheVector.size() > newSize) {
-    BSCache *element = cacheVector.back();
-    cacheMemoryUsage -= element->memorySize();
-    cacheVector.pop_back();
-    cache.erase(element->getHash());
-    delete element;
-  }
-
-  // updating indices of cached objects
-  for (size_t i = 0; i < cacheVector.size(); i++) {
-    cacheVector[i]->index = i;
-    cacheVector[i]->usage = cacheVector[i]->usage == 0 ? 0 : 1;
-  }
-  printf("done in %.2fs!\n\n", (double)(clock() - start) / CLOCKS_PER_SEC);
-}
-
 void BSGraph::createArcs() {
   // as stated in Balas and Simonetti (2001), the nodes can be grouped
   // by (S-,S+), reducing the number of comparisons for creating arcs
@@ -380,12 +335,117 @@ double BSGraph::getEdgeCost(const vector<int> &sequence, int layer, BSNode *pred
   return getDistance(sequence[prevLayer], sequence[nextLayer]);
 }
 
+template <int K>
+void BSGraph::computeConflicts(BSWorkspace &ws, const vector<int> &sequence, int layer) const {
+  PDPNode **nodes = static_cast<PDPNode **>(Application::instance->Data());
+  const int kk = K ? K : (int)k;
+
+  for (int q = 1 - kk; q < kk; q++) {
+    int &minusConflict = ws.minusConflicts[q + kk - 1];
+    int &plusConflict = ws.plusConflicts[q + kk - 1];
+    minusConflict = plusConflict = 0;
+
+    int idx = layer + q;
+    if (idx < 0 || idx >= (int)sequence.size() || sequence[idx] == 0) continue;
+
+    PDPNode *node = nodes[sequence[idx]];
+    int r = ws.locationPosition[node->pair] - layer;
+
+    // a pickup entering here conflicts with its delivery in S^-, a delivery with its pickup in S^+
+    if (node->isPickup && r >= 0 && r < kk) minusConflict = 1 << r;
+    if (node->isDelivery && r < 0 && r > -kk) plusConflict = 1 << -r;
+  }
+}
+
+template <int K>
+bool BSGraph::isFeasible(const BSWorkspace &ws, int succ) const {
+  const int kk = K ? K : (int)k;
+  const int offset = nodePosition[succ] + kk - 1;
+  const int minus = nodeMinus[succ];
+  const int plus = nodePlus[succ];
+
+  int conflict = (minus & ws.minusConflicts[offset]) | (plus & ws.plusConflicts[offset]);
+  for (int j = 1; j < kk; j++) {
+    conflict |= (minus & ws.minusConflicts[kk - 1 - j]) & -((plus >> j) & 1);
+  }
+
+  return !conflict;
+}
+
+template <int K>
+void BSGraph::relaxLayers(BSWorkspace &ws, const vector<int> &sequence, const int firstIndex,
+                          const int lastIndex, const int sizeIdx) const {
+  const int kk = K ? K : (int)k;
+  const int size = lastIndex - firstIndex + 2;
+  const int nNodes = (int)nNodesPerSize[sizeIdx];
+  int *nextLocations = ws.nextLocation.data();
+
+  int layerIdx;
+  uint64_t work = 0;
+  for (int layer = firstIndex; layer <= lastIndex + 1; layer++) {
+    swap(ws.prevDists, ws.dists);
+    double *dists = ws.dists;
+    const double *prevDists = ws.prevDists;
+    fill_n(dists, nNodes, INFINITY);
+
+    // defining layer index (for nodes and successors fast retrieval)
+    if (size <= (int)maxSize) {
+      layerIdx = layer - firstIndex;
+    } else {
+      layerIdx = kk;
+      if (layer - firstIndex < kk)
+        layerIdx = layer - firstIndex;
+      else if (lastIndex + 1 - layer < kk)
+        layerIdx = 2 * kk - (lastIndex + 1 - layer);
+    }
+
+    // edges are free at the ends of the sequence, otherwise their cost is the distance between
+    // the locations they join (see getEdgeCost) when the successor keeps the precedences
+    const bool freeLayer = layer == 0 || layer == (int)sequence.size();
+    if (!freeLayer) {
+      computeConflicts<K>(ws, sequence, layer);
+      for (int succ = 0; succ < nNodes; succ++) {
+        int idx = layer + nodePosition[succ];
+        nextLocations[succ] =
+            (idx >= 0 && idx < (int)sequence.size() && isFeasible<K>(ws, succ)) ? sequence[idx] : -1;
+      }
+    }
+
+    vector<int> &paths = ws.shortestPaths[layer - firstIndex];
+    const int l = sizeIdx * (maxSize + 1) + layerIdx;
+    work += nNodes + succBegin[layerBegin[l + 1]] - succBegin[layerBegin[l]];
+    for (int e = layerBegin[l]; e < layerBegin[l + 1]; e++) {
+      const int node = layerNodes[e];
+      const double prevDist = prevDists[node];
+      const double *prevDistances =
+          freeLayer ? nullptr : distMatrix[sequence[layer - 1 + nodePosition[node]]];
+
+      for (int a = succBegin[e]; a < succBegin[e + 1]; a++) {
+        const int succ = succIds[a];
+
+        double cost = 0;
+        if (!freeLayer) {
+          const int location = nextLocations[succ];
+          cost = location >= 0 ? prevDistances[location] : (double)INFINITY;
+        }
+
+        if (dists[succ] > cost + prevDist) {
+          dists[succ] = cost + prevDist;
+          paths[succ] = node;
+        }
+      }
+    }
+  }
+
+  // one unit per node checked and per arc relaxed
+  Work::Add(work);
+}
+
 BSHash BSGraph::makeBSHash(const vector<int> &sequence, const int firstIndex, const int lastIndex,
                            const double distance) {
   // calculating hash of sequence
-  int begin = (firstIndex - 1 >= 0 && sequence[firstIndex - 1] == 0) ? firstIndex - 1 : firstIndex;
-  int end =
-      (lastIndex + 1 < (int)sequence.size() && sequence[lastIndex + 1] == 0) ? lastIndex + 1 : lastIndex;
+  int begin, end;
+  getCacheRange(sequence, firstIndex, lastIndex, begin, end);
 
   // calculating hash values
   size_t seqHash = (size_t)sequence[begin] + 1;
@@ -400,6 +460,9 @@ BSHash BSGraph::makeBSHash(const vector<int> &sequence, const int firstIndex, co
     setHashRev = (setHashRev + getClientHashRev(sequence[i]));  // % BIG_PRIME;
   }
 
+  // the endpoints are fixed, so sets with different endpoints are different entries
+  setHashRev += cachedMultipliers[1] * (sequence[begin] + 1) + cachedMultipliers[2] * (sequence[end] + 1);
+
   return BSHash(seqHash, seqHashRev, setHash, setHashRev, distance, end - begin + 1);
 }
 
@@ -407,46 +470,48 @@ void BSGraph::preProcessLayers() {
   // auxiliary variable to store the last necessary node
   int lastUsedNode = 0;
 
-  // assigning value to maxSize and pre-allocating vectors
-  nNodesPerSize.assign(maxSize + 1, 0);
-  nodesPerSizeLayer.assign(maxSize + 1, vector<vector<BSNode *> >());
+  // node data in struct-of-arrays form
   for (vector<BSNode *>::iterator nodeIt = nodes.begin(); nodeIt != nodes.end(); nodeIt++) {
     BSNode *node = *nodeIt;
-    node->succsPerSizeLayer.assign(maxSize + 1, vector<vector<BSNode *> >());
+    nodePosition.push_back(node->position);
+    nodeMinus.push_back(node->minus);
+    nodePlus.push_back(node->plus);
   }
 
+  // assigning value to maxSize and pre-allocating vectors
+  nNodesPerSize.assign(maxSize + 1, 0);
+  layerBegin.assign((maxSize + 1) * (maxSize + 1) + 1, 0);
+  succBegin.push_back(0);
+
   // pre-computing the nodes present in each layer and their successors
   for (int size = 0; size <= (int)maxSize; size++) {
-    // pre-allocating vectors
-    nodesPerSizeLayer[size].assign((unsigned int)size, vector<BSNode *>());
-    for (vector<BSNode *>::iterator nodeIt = nodes.begin(); nodeIt != nodes.end(); nodeIt++) {
-      BSNode *node = *nodeIt;
-      node->succsPerSizeLayer[size].assign((unsigned int)size, vector<BSNode *>());
-    }
+    for (int layer = 0; layer <= (int)maxSize; layer++) {
+      layerBegin[size * (maxSize + 1) + layer] = (int)layerNodes.size();
 
-    for (int layer = 0; layer < size; layer++) {
-      for (vector<BSNode *>::iterator nodeIt = nodes.begin(); nodeIt != nodes.end(); nodeIt++) {
+      for (vector<BSNode *>::iterator nodeIt = nodes.begin(); layer < size && nodeIt != nodes.end(); nodeIt++) {
         BSNode *node = *nodeIt;
         if (node != nodes[0] && (node->minPosition + layer <= 0 || node->maxPosition + layer >= size))
           continue;
 
         lastUsedNode = max(lastUsedNode, node->id);
 
-        nodesPerSizeLayer[size][layer].push_back(node);
+        layerNodes.push_back(node->id);
         for (vector<BSNode *>::iterator succIt = node->succs.begin(); succIt != node->succs.end(); succIt++) {
           BSNode *succ = *succIt;
           if (succ != nodes[0] &&
               (succ->minPosition + layer + 1 <= 0 || succ->maxPosition + layer + 1 >= size))
             continue;
 
-          node->succsPerSizeLayer[size][layer].push_back(succ);
+          succIds.push_back(succ->id);
         }
+        succBegin.push_back((int)succIds.size());
       }
     }
 
     // calculating number of necessary nodes for a sequence *size*
     nNodesPerSize[size] = (unsigned int)lastUsedNode + 1;
   }
+  layerBegin.back() = (int)layerNodes.size();
 
   if (BSGRAPH_DEBUG) {
     // printing nodes in each layer
@@ -455,17 +520,13 @@ void BSGraph::preProcessLayers() {
       printf("size: %d\n", size);
       for (int layer = 0; layer < size; layer++) {
         printf("layer[%d] = ", layer);
-        for (vector<BSNode *>::iterator nodeIt = nodesPerSizeLayer[size][layer].begin();
-             nodeIt != nodesPerSizeLayer[size][layer].end(); nodeIt++) {
-          BSNode *node = *nodeIt;
-          printf("%d", node->id + 1);
-          if (!node->succsPerSizeLayer[size][layer].empty()) {
+        int l = size * (maxSize + 1) + layer;
+        for (int e = layerBegin[l]; e < layerBegin[l + 1]; e++) {
+          printf("%d", layerNodes[e] + 1);
+          if (succBegin[e] != succBegin[e + 1]) {
             printf("[");
-            for (vector<BSNode *>::iterator succIt = node->succsPerSizeLayer[size][layer].begin();
-                 succIt != node->succsPerSizeLayer[size][layer].end(); succIt++) {
-              BSNode *succ = *succIt;
-              printf("%d,", succ->id + 1);
-            }
+            for (int a = succBegin[e]; a < succBegin[e + 1]; a++)
+              printf("%d,", succIds[a] + 1);
             printf("]");
           }
           printf(" ");
@@ -477,32 +538,16 @@ void BSGraph::preProcessLayers() {
   }
 }
 
-bool BSGraph::runBS(vector<int> &sequence, const int firstIndex, const int lastIndex,
-                    const double inputDistance, const BSHash &hash) {
-  if (lastIndex - firstIndex <= 2) return false;
-
-  distance = inputDistance;
-  if (firstIndex >= lastIndex) return false;
-  // if (clock() > maxClock) return false;
-
-  if (BSGRAPH_DEBUG) {
-    // calculating and printing the initial cost
-    double initialCost = 0;
-    for (uint i = 1; i < sequence.size(); i++) {
-      int prevLayer = i - 1;
-      int nextLayer = i == sequence.size() ? 0 : i;
-      initialCost += getDistance(sequence[prevLayer], sequence[nextLayer]);
-    }
-    printf("initial cost = %.2f\n", initialCost);
-  }
-
+void BSGraph::shortestPath(BSWorkspace &ws, vector<int> &sequence, const int firstIndex, const int lastIndex,
+                           const double inputDistance) const {
+  ws.distance = inputDistance;
   int size = lastIndex - firstIndex + 2;
   int sizeIdx = min(size, (int)maxSize);
 
   // creating (if necessary) *shortestPaths* structure using O(size *
   // nodes.size()) memory
-  if (shortestPaths.size() <= (unsigned int)size)
-    shortestPaths.assign((unsigned int)size + 1, vector<BSNode *>(nodes.size()));
+  if (ws.shortestPaths.size() <= (unsigned int)size)
+    ws.shortestPaths.assign((unsigned int)size + 1, vector<int>(nodes.size()));
 
   // computing cost of the fixed part of the sequence
   double fixedCost = 0;
@@ -516,134 +561,118 @@ bool BSGraph::runBS(vector<int> &sequence, const int firstIndex, const int lastI
     // if (clock() > maxClock) break;
 
     // setting initial values of auxiliary structure *_costs*
-    fill_n(dists, nNodesPerSize[sizeIdx], fixedCost);
-
-    // computing (forward) shortest paths for the layered graph in O(edges)
-    int layerIdx;
-    for (int layer = firstIndex; layer <= lastIndex + 1; layer++) {
-      swap(prevDists, dists);
-      fill_n(dists, nNodesPerSize[sizeIdx], INFINITY);
+    fill_n(ws.dists, nNodesPerSize[sizeIdx], fixedCost);
 
-      // defining layer index (for nodes and successors fast retrieval)
-      if (size <= (int)maxSize) {
-        layerIdx = layer - firstIndex;
-      } else {
-        layerIdx = k;
-        if (layer - firstIndex < (int)k)
-          layerIdx = layer - firstIndex;
-        else if (lastIndex + 1 - layer < (int)k)
-          layerIdx = 2 * k - (lastIndex + 1 - layer);
-      }
+    for (int i = 0; i < (int)sequence.size(); i++)
+      ws.locationPosition[sequence[i]] = i;
 
-      for (vector<BSNode *>::iterator nodeIt = nodesPerSizeLayer[sizeIdx][layerIdx].begin();
-           nodeIt != nodesPerSizeLayer[sizeIdx][layerIdx].end(); nodeIt++) {
-        BSNode *node = *nodeIt;
-        for (vector<BSNode *>::iterator succIt = node->succsPerSizeLayer[sizeIdx][layerIdx].begin();
-             succIt != node->succsPerSizeLayer[sizeIdx][layerIdx].end(); succIt++) {
-          BSNode *succ = *succIt;
-          if (dists[succ->id] > getEdgeCost(sequence, layer, node, succ) + prevDists[node->id]) {
-            dists[succ->id] = getEdgeCost(sequence, layer, node, succ) + prevDists[node->id];
-            shortestPaths[layer - firstIndex][succ->id] = node;
-          }
-        }
-      }
+    // computing (forward) shortest paths for the layered graph in O(edges)
+    switch (k) {
+      case 2:
+        relaxLayers<2>(ws, sequence, firstIndex, lastIndex, sizeIdx);
+        break;
+      case 3:
+        relaxLayers<3>(ws, sequence, firstIndex, lastIndex, sizeIdx);
+        break;
+      case 4:
+        relaxLayers<4>(ws, sequence, firstIndex, lastIndex, sizeIdx);
+        break;
+      case 5:
+        relaxLayers<5>(ws, sequence, firstIndex, lastIndex, sizeIdx);
+        break;
+      case 6:
+        relaxLayers<6>(ws, sequence, firstIndex, lastIndex, sizeIdx);
+        break;
+      default:
+        relaxLayers<0>(ws, sequence, firstIndex, lastIndex, sizeIdx);
+        break;
     }
 
     // updating distance (for future use)
-    improvement = dists[0] < distance - EPS;
-    distance = dists[0];
+    improvement = ws.dists[0] < ws.distance - EPS;
+    ws.distance = ws.dists[0];
 
     // computing resulting sequence (only for the 'optimized' subsequence)
-    // result_vec.resize((unsigned int) size);
-    vector<int> &result = result_vec;
-    BSNode *node = shortestPaths[lastIndex - firstIndex + 1][0];
+    vector<int> &result = ws.result;
+    int node = ws.shortestPaths[lastIndex - firstIndex + 1][0];
     for (int i = lastIndex; i >= firstIndex; i--) {
-      result[i - firstIndex] = sequence[i + node->position];
-      node = shortestPaths[i - firstIndex][node->id];
+      result[i - firstIndex] = sequence[i + nodePosition[node]];
+      node = ws.shortestPaths[i - firstIndex][node];
     }
 
     // updating original sequence
     for (int i = lastIndex; i >= firstIndex; i--)
       sequence[i] = result[i - firstIndex];
   }
+}
 
-  // checking if there was any improvement during the search
-  improvement = distance < inputDistance - EPS;
+void BSGraph::initWorkspace(BSWorkspace &ws) const {
+  ws.prevDists = new double[nodes.size()];
+  ws.dists = new double[nodes.size()];
+  ws.locationPosition.assign(nLocations + 1, 0);
+  ws.minusConflicts.assign(2 * k - 1, 0);
+  ws.plusConflicts.assign(2 * k - 1, 0);
+  ws.nextLocation.assign(nodes.size(), -1);
+  ws.result.resize(nLocations + 2);
+}
 
-  // caching result
-  if (CACHE_RESULTS) {
-#ifdef NO_TUNNELING
-    BSCache *cachedResult = new BSCache(hash);
-    int begin = (firstIndex - 1 >= 0 && sequence[firstIndex - 1] == 0) ? firstIndex - 1 : firstIndex;
-    int end =
-        (lastIndex + 1 < (int)sequence.size() && sequence[lastIndex + 1] == 0) ? lastIndex + 1 : lastIndex;
-
-    cachedResult->distance = distance;
-    if (improvement) {
-      cachedResult->sequence = new int[end - begin + 1];
-      for (int i = begin; i <= end; i++)
-        cachedResult->sequence[i - begin] = params->correspondanceTable[sequence[i]];
-    }
+bool BSGraph::runBS(vector<int> &sequence, const int firstIndex, const int lastIndex,
+                    const double inputDistance, const BSHash &hash) {
+  if (lastIndex - firstIndex <= 2) return false;
 
-    clearCache();
+  distance = inputDistance;
+  if (firstIndex >= lastIndex) return false;
+  // if (clock() > maxClock) return false;
 
-    cache[hash] = cachedResult;
-    cachedResult->index = cacheVector.size();
-    cacheVector.push_back(cachedResult);
-    cacheMemoryUsage += cachedResult->memorySize();
-#else
-    BSCache *cachedResult = nullptr;
-    int begin = (firstIndex - 1 >= 0 && sequence[firstIndex - 1] == 0) ? firstIndex - 1 : firstIndex;
-    int end =
-        (lastIndex + 1 < (int)sequence.size() && sequence[lastIndex + 1] == 0) ? lastIndex + 1 : lastIndex;
+  if (BSGRAPH_DEBUG) {
+    // calculating and printing the initial cost
+    double initialCost = 0;
+    for (uint i = 1; i < sequence.size(); i++) {
+      int prevLayer = i - 1;
+      int nextLayer = i == sequence.size() ? 0 : i;
+      initialCost += getDistance(sequence[prevLayer], sequence[nextLayer]);
+    }
+    printf("initial cost = %.2f\n", initialCost);
+  }
 
-    // querying for a previous cached sequence for the current set of customers
-    auto mapIt = cache.find(hash.setHash);
+  shortestPath(workspace, sequence, firstIndex, lastIndex, inputDistance);
+  distance = workspace.distance;
 
-    if (mapIt == cache.end()) {
-      // creating a new cache entry since none exists for this set of customers
-      cachedResult = new BSCache(hash.setHash);
+  // checking if there was any improvement during the search
+  bool improvement = distance < inputDistance - EPS;
 
-      cachedResult->distance = distance;
-      cachedResult->sequence = new int[end - begin + 1];
-      for (int i = begin; i <= end; i++)
-        cachedResult->sequence[i - begin] = sequence[i];
+  // caching result
+  if (cache != nullptr) {
+    int begin, end;
+    getCacheRange(sequence, firstIndex, lastIndex, begin, end);
+    double pathCost = getPathCost(sequence, begin, end);
 
-      clearCache();
+    // querying for a previous cached sequence for the current set of customers
+    BSCacheEntry *cachedResult = cache->find(hash.setHash);
 
-      cache[cachedResult->getHash()] = cachedResult;
-      cachedResult->index = cacheVector.size();
-      cacheVector.push_back(cachedResult);
+    if (cachedResult == nullptr) {
+      // creating a new cache entry since none exists for this set of customers
+      cachedResult = cache->insert(hash.setHash);
+      cachedResult->distance = pathCost;
+      copy(sequence.begin() + begin, sequence.begin() + end + 1, cachedResult->sequence());
     }
 
-    else {
-      cachedResult = mapIt->second;
-      cacheMemoryUsage -= cachedResult->memorySize();
-
-      if (distance <= mapIt->second->distance - EPS) {
-        // updating old cache entry with the improved sequence
-
-        cachedResult->distance = distance;
-        for (int i = begin; i <= end; i++)
-          cachedResult->sequence[i - begin] = sequence[i];
-      }
-
-      else if (mapIt->second->distance <= distance - EPS) {
-        // using the sequence stored in the cache since it is better than the
-        // sequence produced
-        cachedResult = mapIt->second;
+    else if (pathCost <= cachedResult->distance - EPS) {
+      // updating old cache entry with the improved sequence
+      cachedResult->distance = pathCost;
+      copy(sequence.begin() + begin, sequence.begin() + end + 1, cachedResult->sequence());
+    }
 
-        // updating sequence and distance
-        for (int i = begin; i <= end; i++)
-          sequence[i] = cachedResult->sequence[i - begin];
-        distance = cachedResult->distance;
-        improvement = true;
-      }
+    else if (cachedResult->distance <= pathCost - EPS) {
+      // using the sequence stored in the cache since it is better than the
+      // sequence produced
+      copy(cachedResult->sequence(), cachedResult->sequence() + (end - begin + 1), sequence.begin() + begin);
+      distance += cachedResult->distance - pathCost;
+      improvement = true;
     }
 
+    cachedResult->referenced = 1;
     cachedResult->insert(hash.routeHash);
-    cacheMemoryUsage += cachedResult->memorySize();
-#endif
   }
 
   return improvement;
@@ -651,186 +680,56 @@ bool BSGraph::runBS(vector<int> &sequence, const int firstIndex, const int lastI
 
 bool BSGraph::updateFromCache(const BSHash &hash, vector<int> &sequence, const int begin, const int end,
                               bool &doubleCheck) {
-  cacheQueries++;
-#ifdef NO_TUNNELING
-  std::unordered_map<BSHash, BSCache *, BSHash>::const_iterator mapIt = cache.find(hash);
-#else
-  std::unordered_map<BSSetHash, BSCache *, BSSetHash>::const_iterator mapIt = cache.find(hash.setHash);
-#endif
-  if (mapIt == cache.end()) return false;
-
-  BSCache *element = mapIt->second;
-#ifdef NO_TUNNELING
-#else
-  if (!element->has(hash.routeHash)) return false;
-#endif
-
-  if (element->distance <= distance + EPS) {
-#ifdef NO_TUNNELING
-    try {
-      if (doubleCheck && element->sequence != nullptr) {
-        // double-checking element-set
-        stringstream error;
-        if (end - begin + 1 > 0 && mapIt->first.setHash.size != end - begin + 1) {
-          error << "mapIt->first.setHash.size != end - begin + 1: " << mapIt->first.setHash.size << " vs "
-                << (end - begin + 1);
-          doubleCheck = false;
-          // throw std::runtime_error(error.str());
-        }
-        set<int> items;
-        for (int i = begin; i <= end; i++)
-          items.insert(params->correspondanceTable2[element->sequence[i - begin]]);
-        for (int i = begin; i <= end; i++) {
-          if (items.count(sequence[i]) != 1) {
-            set<int> second;
-            for (int j = begin; j <= end; j++)
-              second.insert(sequence[j]);
-
-            error << "hash failure! sets are different (for " << params->nbClients << " clients):";
-            for (int idx : items)
-              error << " " << idx;
-            error << " versus";
-            for (int idx : second)
-              error << " " << idx;
-            // throw std::runtime_error(error.str());
-            doubleCheck = false;
-          }
-        }
-
-        if (!doubleCheck) {
-          cerr << endl << error.str() << endl;
-          cout << endl << error.str() << endl;
-
-          assert(element == cacheVector[element->index]);
-
-          // moving last element to position element->index
-          cacheVector[element->index] = cacheVector.back();
-          cacheVector[element->index]->index = element->index;
-          cacheVector.pop_back();
-
-          // freeing memory
-          cache.erase(element->getHash());
-          delete element;
-          return false;
-        }
-      }
-    } catch (int errorCode) {
-      cerr << endl << "Fatal error with code " << errorCode << endl;
-      cout << endl << "Fatal error with code " << errorCode << endl;
-
-      // moving last element to position element->index
-      cacheVector[element->index] = cacheVector.back();
-      cacheVector[element->index]->index = element->index;
-      cacheVector.pop_back();
-
-      // freeing memory
-      cache.erase(element->getHash());
-      delete element;
+  cache->queries++;
+  BSCacheEntry *element = cache->find(hash.setHash);
+  if (element == nullptr || !element->has(hash.routeHash)) return false;
+
+  double pathCost = getPathCost(sequence, begin, end);
+  if (element->distance > pathCost + EPS) return false;
+
+  if (doubleCheck) {
+    // double-checking element-set
+    vector<int> items(element->sequence(), element->sequence() + (end - begin + 1));
+    vector<int> second(sequence.begin() + begin, sequence.begin() + end + 1);
+    sort(items.begin(), items.end());
+    sort(second.begin(), second.end());
+
+    if (items != second) {
+      stringstream error;
+      error << "hash failure! sets are different (for " << nLocations << " clients):";
+      for (int idx : items)
+        error << " " << idx;
+      error << " versus";
+      for (int idx : second)
+        error << " " << idx;
+      cerr << endl << error.str() << endl;
+
+      cache->erase(element);
+      cache->collisions++;
+      doubleCheck = false;
       return false;
     }
-#else
-    try {
-      if (doubleCheck) {
-        // double-checking element-set
-        stringstream error;
-        if (end - begin + 1 > 0 && mapIt->first.size != end - begin + 1) {
-          error << "mapIt->first.size != end - begin + 1: " << mapIt->first.size << " vs "
-                << (end - begin + 1);
-          doubleCheck = false;
-          // throw std::runtime_error(error.str());
-        }
-        set<int> items;
-        for (int i = begin; i <= end; i++)
-          items.insert(element->sequence[i - begin]);
-        for (int i = begin; i <= end; i++) {
-          if (items.count(sequence[i]) != 1) {
-            set<int> second;
-            for (int j = begin; j <= end; j++)
-              second.insert(sequence[j]);
-
-            error << "hash failure! sets are different (for " << nLocations << " clients):";
-            for (int idx : items)
-              error << " " << idx;
-            error << " versus";
-            for (int idx : second)
-              error << " " << idx;
-            // throw std::runtime_error(error.str());
-            doubleCheck = false;
-          }
-        }
-
-        if (!doubleCheck) {
-          cerr << endl << error.str() << endl;
-          cout << endl << error.str() << endl;
-
-          assert(element == cacheVector[element->index]);
-
-          // moving last element to position element->index
-          cacheVector[element->index] = cacheVector.back();
-          cacheVector[element->index]->index = element->index;
-          cacheVector.pop_back();
-
-          // freeing memory
-          cacheMemoryUsage -= element->memorySize();
-          cache.erase(element->getHash());
-          delete element;
-          return false;
-        }
-      }
-    } catch (int errorCode) {
-      cerr << endl << "Fatal error with code " << errorCode << endl;
-      cout << endl << "Fatal error with code " << errorCode << endl;
-
-      // moving last element to position element->index
-      cacheVector[element->index] = cacheVector.back();
-      cacheVector[element->index]->index = element->index;
-      cacheVector.pop_back();
-
-      // freeing memory
-      cacheMemoryUsage -= element->memorySize();
-      cache.erase(element->getHash());
-      delete element;
-      return false;
-    }
-#endif
-
-    if (element->distance >= distance - EPS || element->sequence == nullptr) {
-      cacheSideways++;
-    } else {
-      // updating sequence and distance
-      for (int i = begin; i <= end; i++)
-        sequence[i] = element->sequence[i - begin];
-      distance = element->distance;
-      cacheImprovement++;
-    }
-
-    element->usage++;
-    return true;
   }
 
-  else {
-#ifdef NO_TUNNELING
-    assert(element == cacheVector[element->index]);
-
-    // moving last element to position element->index
-    cacheVector[element->index] = cacheVector.back();
-    cacheVector[element->index]->index = element->index;
-    cacheVector.pop_back();
-
-    // freeing memory
-    cache.erase(element->getHash());
-    delete element;
-
-    cacheRemoval++;
-    return false;
-#else
-    return false;
-#endif
+  if (element->distance < pathCost - EPS) {
+    // updating sequence and distance
+    copy(element->sequence(), element->sequence() + (end - begin + 1), sequence.begin() + begin);
+    distance += element->distance - pathCost;
+    cache->improvements++;
   }
+
+  element->referenced = 1;
+  cache->hits++;
+  return true;
 }
 
 bool BSGraph::updateOrder(vector<int> &sequence, double &updatedDistance) {
-  bool result = updateOrder(sequence, 1, (int)sequence.size() - 2);
+  return updateOrder(sequence, updatedDistance, 1, (int)sequence.size() - 2);
+}
+
+bool BSGraph::updateOrder(vector<int> &sequence, double &updatedDistance, const int firstIndex,
+                          const int lastIndex) {
+  bool result = updateOrder(sequence, firstIndex, lastIndex);
   if (result) updatedDistance = distance;
   return result;
 }
@@ -849,30 +748,92 @@ bool BSGraph::updateOrder(vector<int> &sequence, const int firstIndex, const int
 
   if (firstIndex >= lastIndex) return false;
 
+  if (cache == nullptr) return runBS(sequence, firstIndex, lastIndex, distance, BSHash());
+
   // checking for previous calculated sequence (and maybe replacing by current)
   BSHash hash = makeBSHash(sequence, firstIndex, lastIndex, distance);
-  if (CACHE_RESULTS) {
-    double prevDistance = distance;
-    int begin = (firstIndex - 1 >= 0 && sequence[firstIndex - 1] == 0) ? firstIndex - 1 : firstIndex;
-    int end =
-        (lastIndex + 1 < (int)sequence.size() && sequence[lastIndex + 1] == 0) ? lastIndex + 1 : lastIndex;
-    if (updateFromCache(hash, sequence, begin, end, doubleCheck)) return distance <= prevDistance - EPS;
-  }
+  double prevDistance = distance;
+  int begin, end;
+  getCacheRange(sequence, firstIndex, lastIndex, begin, end);
+  if (updateFromCache(hash, sequence, begin, end, doubleCheck)) return distance <= prevDistance - EPS;
 
   return runBS(sequence, firstIndex, lastIndex, distance, hash);
 }
 
+bool BSGraph::updateOrderBlocks(vector<int> &sequence, double &updatedDistance, ThreadPool *pool) {
+  const int n = (int)sequence.size();
+  const int nThreads = pool->Size();
+  while ((int)threadWorkspaces.size() < nThreads) {
+    threadWorkspaces.push_back(new BSWorkspace());
+    initWorkspace(*threadWorkspaces.back());
+  }
+
+  // blocks [1 + b * blockSize, (b + 1) * blockSize - 1] are separated by a fixed location, so
+  // they share no edge and can be reordered independently; the odd passes reorder windows of
+  // 4k + 3 locations (2k + 1 on each side) centered on those fixed locations instead
+  const int blockSize = max(BS_BLOCK_SIZE, (int)(8 * maxSize));
+  const int halfWindow = (int)maxSize;
+  const int nBlocks = (n - 2 + blockSize - 1) / blockSize;
+
+  double inputDistance = getPathCost(sequence, 0, n - 1);
+  distance = inputDistance;
+
+  vector<int> merged;
+  for (int pass = 0;; pass++) {
+    const bool boundaries = pass % 2 == 1;
+    const int nWindows = boundaries ? nBlocks - 1 : nBlocks;
+    if (nWindows <= 0) break;
+
+    // every window starts from the sequence of the beginning of the pass, so the results do not
+    // depend on the number of threads
+    merged = sequence;
+    auto task = [&](int t) {
+      BSWorkspace &ws = *threadWorkspaces[t];
+      ws.sequence = sequence;
+      for (int w = t; w < nWindows; w += nThreads) {
+        int first = boundaries ? (w + 1) * blockSize - halfWindow : 1 + w * blockSize;
+        int last = boundaries ? (w + 1) * blockSize + halfWindow : min(n - 2, (w + 1) * blockSize - 1);
+        last = min(last, n - 2);
+        if (last - first <= 2) continue;
+
+        shortestPath(ws, ws.sequence, first, last, distance);
+        if (ws.distance < distance - EPS)
+          copy(ws.sequence.begin() + first, ws.sequence.begin() + last + 1, merged.begin() + first);
+        copy(sequence.begin() + first, sequence.begin() + last + 1, ws.sequence.begin() + first);
+      }
+    };
+    if (!pool->Run(task)) {
+      for (int t = 0; t < nThreads; t++)
+        task(t);
+    }
+
+    double mergedDistance = getPathCost(merged, 0, n - 1);
+    bool improvement = mergedDistance < distance - EPS;
+    if (improvement) {
+      sequence.swap(merged);
+      distance = mergedDistance;
+    }
+
+    // both kinds of windows are locally optimal once a pass after the first one does not improve
+    if (!improvement && pass > 0) break;
+  }
+
+  if (distance < inputDistance - EPS) {
+    updatedDistance = distance;
+    return true;
+  }
+  return false;
+}
+
 BSGraph::~BSGraph() {
-  for (vector<BSCache *>::iterator cacheIt = cacheVector.begin(); cacheIt != cacheVector.end(); cacheIt++)
-    delete *cacheIt;
-  cacheVector.clear();
+  delete cache;
+
+  for (size_t t = 0; t < threadWorkspaces.size(); t++)
+    delete threadWorkspaces[t];
 
   for (vector<BSNode *>::iterator nodeIt = nodes.begin(); nodeIt != nodes.end(); nodeIt++)
     delete *nodeIt;
   nodes.clear();
-
-  delete[] prevDists;
-  delete[] dists;
 }
 
 #endif  // BALAS_SIMONETTI
@@ -31,6 +31,8 @@
 #include "bscache.h"
 #include "util.h"
 
+class ThreadPool;
+
 using namespace std;
 
 /*===========================================================================*/
@@ -79,9 +81,6 @@ class BSNode {
     /// nodes that are successors of this node in the graph (set of nodes)
     std::vector<BSNode*> succs;
 
-    /// pre-processed successors (for a specific graph size and layer)
-    std::vector<std::vector<std::vector<BSNode*>>> succsPerSizeLayer;
-
     /**
      * Checks (in constant time) if a position is part of the S^- set
      */
@@ -102,6 +101,56 @@ class BSNode {
     std::string toString() const;
 };
 
+/*===========================================================================*/
+// BSWorkspace class
+/*===========================================================================*/
+
+/**
+ * Auxiliary structures used to compute the shortest paths of the layered graph.
+ * The graph itself is read-only, so threads optimizing different sequences only
+ * need their own workspace.
+ */
+struct BSWorkspace {
+  public:
+    BSWorkspace() : prevDists(nullptr), dists(nullptr), distance(0) {
+    }
+
+    ~BSWorkspace() {
+      delete[] prevDists;
+      delete[] dists;
+    }
+
+    /// distances of the nodes of the previous and the current layers
+    double *prevDists, *dists;
+
+    /// auxiliary matrix that keeps the shortest paths (ids of the predecessors)
+    std::vector<std::vector<int>> shortestPaths;
+
+    /// position of each location in the sequence being optimized
+    std::vector<int> locationPosition;
+
+    /// pickup/delivery conflicts of the current layer, indexed by relative position + k - 1: the
+    /// S^- (resp. S^+) bit of the delivery (resp. pickup) paired with the location at that position
+    std::vector<int> minusConflicts, plusConflicts;
+
+    /// location entered by each node (as a successor) at the current layer, -1 if the node breaks
+    /// a precedence
+    std::vector<int> nextLocation;
+
+    /// resulting (optimized) subsequence
+    std::vector<int> result;
+
+    /// private copy of the sequence (when reordering blocks in parallel)
+    std::vector<int> sequence;
+
+    /// distance of the last shortest path computed
+    double distance;
+
+  private:
+    BSWorkspace(const BSWorkspace&);
+    BSWorkspace& operator=(const BSWorkspace&);
+};
+
 /*===========================================================================*/
 // BSGraph class
 /*===========================================================================*/
@@ -120,6 +169,7 @@ class BSGraph {
      * @param total number of clients in the problem
      * @param distMatrix original matrix with the distances between every two clients
      * @param maxTime the time in which the algorithm MUST stop running
+     * @param maxMemory memory (in bytes) of the results cache (0 disables the cache)
      */
     BSGraph(unsigned int k, unsigned int nLocations, double** distMatrix, clock_t maxTime, size_t maxMemory);
 
@@ -138,6 +188,9 @@ class BSGraph {
     /// maxmimum memory the cache may use
     const size_t maxMemory;
 
+    /// cache of optimized sequences (nullptr if disabled)
+    BSCache* cache;
+
     /// the maximum size (maximum number of "non-repeated" layers) of the graph
     /// this value is generally a constant: size = (k*2) + 1
     unsigned int maxSize;
@@ -154,8 +207,6 @@ class BSGraph {
     /// number of necessary nodes to process a sequence with *size* nodes
     std::vector<unsigned int> nNodesPerSize;
 
-    /// pre-processed nodes of a specific graph considering *size* and *layer*
-    std::vector<std::vector<std::vector<BSNode*>>> nodesPerSizeLayer;
 
     /// nodes per class (a class is given by a pair (S^-,S^+))
     std::vector<std::vector<BSNode*>> nodeClasses;
@@ -163,9 +214,6 @@ class BSGraph {
     /// distance of the last shortest path computed
     double distance;
 
-    /// basic usage statistics
-    size_t cacheQueries, cacheImprovement, cacheSideways, cacheRemoval, cacheCollisions, cacheCleanUps;
-
     /**
      * Gets the individual hashCode of the customer given as argument.
      *
@@ -236,18 +284,37 @@ class BSGraph {
 
     /**
      * Wrapper functions to calculate the best ordering of a sequence considering up to k changes.
+     * Only the window [firstIndex, lastIndex] is reordered; by default, the whole route.
      *
      * @param sequence ordered vector with clients to update
+     * @param updatedDistance total distance of the sequence (only set if improved)
      * @param firstIndex index of the first item that may be changed
      * @param lastIndex index of the last item that may be changed
      *
      * @return true if route is improved and false otherwise
      */
     bool updateOrder(vector<int>& sequence, double& updatedDistance);
+    bool updateOrder(vector<int>& sequence, double& updatedDistance, const int firstIndex,
+                     const int lastIndex);
     bool updateOrder(std::vector<int>& sequence, const int firstIndex, const int lastIndex);
     bool updateOrder(std::vector<int>& sequence, const int firstIndex, const int lastIndex,
                      bool& doubleCheck);
 
+    /**
+     * Calculates a better ordering of a sequence considering up to k changes, reordering
+     * blocks of the sequence in parallel. The blocks are separated by fixed locations, so their
+     * results are merged without conflicts, and passes alternate with windows centered on those
+     * locations until neither improves. The result is a local optimum of both kinds of windows,
+     * which is not always the ordering found by updateOrder. Neither the cache nor rand() is used.
+     *
+     * @param sequence ordered vector with clients to update
+     * @param updatedDistance total distance of the sequence (only set if improved)
+     * @param pool threads running the blocks (the blocks run serially if the pool is busy)
+     *
+     * @return true if route is improved and false otherwise
+     */
+    bool updateOrderBlocks(std::vector<int>& sequence, double& updatedDistance, ThreadPool* pool);
+
     /**
      * Creates a hash value (given by three numbers) for an input given sequence.
      *
@@ -270,28 +337,19 @@ class BSGraph {
     /// cached hash values for customers and multipliers
     std::vector<size_t> cachedHashCodes, cachedHashCodesRev, cachedMultipliers;
 
-    /// hash list to maintain already processed sequences
-#ifdef NO_TUNNELING
-    std::unordered_map<BSHash, BSCache*, BSHash> cache;
-#else
-    std::unordered_map<BSSetHash, BSCache*, BSSetHash> cache;
-#endif
-    /// vector to maintain last used cached values
-    std::vector<BSCache*> cacheVector;
+    /// workspace of the (single-threaded) calls
+    BSWorkspace workspace;
 
-    /// counter to control memory usage of the cache
-    size_t cacheMemoryUsage;
-
-    /// auxiliary structures used to compute the shortest paths
-    double *prevDists, *dists;
+    /// workspaces of the threads reordering blocks in parallel
+    std::vector<BSWorkspace*> threadWorkspaces;
 
-    /// auxiliary matrix that keeps the shortest paths
-    std::vector<std::vector<BSNode*>> shortestPaths;
+    /// pre-processed graph in CSR form: the nodes of (size, layer) are
+    /// layerNodes[layerBegin[l]..layerBegin[l + 1]) with l = size * (maxSize + 1) + layer, and the
+    /// successors of entry e are succIds[succBegin[e]..succBegin[e + 1])
+    std::vector<int> layerBegin, layerNodes, succBegin, succIds;
 
-    /**
-     * Removes elements from the cache to open up space for new elements.
-     */
-    void clearCache();
+    /// node data (position, S^- and S^+ bit-sets) in struct-of-arrays form, indexed by node id
+    std::vector<int> nodePosition, nodeMinus, nodePlus;
 
     /**
      * Creates the arcs between nodes (it is mandatory to call createNodes()
@@ -310,14 +368,85 @@ class BSGraph {
      */
     void preProcessLayers();
 
+    /**
+     * Allocates the auxiliary structures of a workspace.
+     */
+    void initWorkspace(BSWorkspace& ws) const;
+
+    /**
+     * Reorders sequence[firstIndex..lastIndex] along the shortest path of the layered graph,
+     * until no improvement is found. Only uses the (read-only) graph and the given workspace,
+     * where the resulting distance is stored.
+     *
+     * @param ws workspace of the calling thread
+     * @param sequence ordered vector with clients to update
+     * @param firstIndex index of the first item that may be changed
+     * @param lastIndex index of the last item that may be changed
+     * @param inputDistance initial distance
+     */
+    void shortestPath(BSWorkspace& ws, std::vector<int>& sequence, const int firstIndex, const int lastIndex,
+                      const double inputDistance) const;
+
+    /**
+     * Computes the (forward) shortest paths of the layered graph in O(edges). The kernel is
+     * specialized for K = 2..6, so the loops over S^- and S^+ are unrolled; K = 0 is the generic
+     * kernel for any k.
+     *
+     * @param ws workspace of the calling thread
+     * @param sequence ordered vector with clients' id
+     * @param firstIndex index of the first item that may be changed
+     * @param lastIndex index of the last item that may be changed
+     * @param sizeIdx pre-processed graph size used for the sequence
+     */
+    template <int K>
+    void relaxLayers(BSWorkspace& ws, const std::vector<int>& sequence, const int firstIndex,
+                     const int lastIndex, const int sizeIdx) const;
+
+    /**
+     * Computes the pickup/delivery conflicts of the locations around a layer.
+     *
+     * @param ws workspace of the calling thread
+     * @param sequence ordered vector with clients' id
+     * @param layer layer under analysis
+     */
+    template <int K>
+    void computeConflicts(BSWorkspace& ws, const std::vector<int>& sequence, int layer) const;
+
+    /**
+     * Checks (with bit operations) if entering a node at the current layer keeps every pickup
+     * before its delivery. Only depends on the successor node, so it is done once per layer.
+     *
+     * @param ws workspace of the calling thread
+     * @param succ id of the node of the next layer
+     */
+    template <int K>
+    bool isFeasible(const BSWorkspace& ws, int succ) const;
+
+    /**
+     * Gets the range of the sequence identifying the window [firstIndex, lastIndex] in the cache:
+     * the window plus its (fixed) neighbors.
+     */
+    inline void getCacheRange(const std::vector<int>& sequence, const int firstIndex, const int lastIndex,
+                              int& begin, int& end) const {
+      begin = firstIndex > 0 ? firstIndex - 1 : firstIndex;
+      end = lastIndex + 1 < (int)sequence.size() ? lastIndex + 1 : lastIndex;
+    }
+
+    /**
+     * Gets the cost of the path sequence[begin..end].
+     */
+    inline double getPathCost(const std::vector<int>& sequence, const int begin, const int end) const {
+      double cost = 0;
+      for (int i = begin + 1; i <= end; i++)
+        cost += getDistance(sequence[i - 1], sequence[i]);
+      return cost;
+    }
+
     /**
      * Returns a cached solution (if any exists) for a given input.
      */
     bool updateFromCache(const BSHash& hash, std::vector<int>& sequence, const int begin, const int end,
                          bool& doubleCheck);
-
-  private:
-    vector<int> result_vec;
 };
 
 #endif  // BALAS_SIMONETTI
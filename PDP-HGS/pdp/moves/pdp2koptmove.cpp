@@ -1,62 +1,130 @@
 #include "pdp2koptmove.h"
 
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "pdp/pdpprecedenceindex.h"
 #include "pdp/pdproute.h"
 #include "utils/application.h"
+#include "utils/threadpool.h"
+#include "utils/work.h"
 
 using namespace std;
 
 namespace pdp {
 namespace moves {
 
-k2opmem infk2 = k2opmem(0, 0, 0, DBL_MAX);
+#define K2CELL(i, d) (diagonal[d] + (i))
+#define K2MEM(i, d) (&mem[2 * K2CELL(i, d)])
+
+k2opmem infk2 = k2opmem(-1, -1, DBL_MAX);
 inline k2opmem& Best(k2opmem& a, k2opmem& b) {
   return (a.cost < b.cost) ? a : b;
 }
 
-k2opmem& Best(k2opmem* m1, k2opmem* m2) {
-  return Best(*m1, *m2);
+void PDP2koptMove::ApplyK2opt(int* s, int entry, int& count) const {
+  const k2opmem& bestMove = mem[entry];
+  if (bestMove.next >= 0) {
+    ApplyK2opt(s, bestMove.next, count);
+  }
+
+  if (bestMove.cell >= 0) {
+    int d = (int)(std::upper_bound(diagonal, diagonal + band + 1, bestMove.cell) - diagonal) - 1;
+    int I = bestMove.cell - diagonal[d];
+    std::reverse(&s[I + 1], &s[I + d + 1]);
+    count++;
+  }
 }
 
-void ApplyK2opt(int* s, k2opmem* bestMove, int& count) {
-  if (bestMove->next) {
-    ApplyK2opt(s, bestMove->next, count);
+void PDP2koptMove::ComputeDiagonal(const int* s, int k, int begin, int end, double* scratch) {
+  if (begin >= end) return;
+
+  PDPNode** instance = (PDPNode**)(Application::instance->Data());
+  double** distance = Application::instance->Distances();
+
+  // cross deltas of the whole range first: D(s[i], s[i + k]) is shared by cells i - 1 and i
+  double* cross = scratch;
+  double* delta = scratch + (end - begin + 1);
+  for (int i = begin; i <= end; i++) {
+    cross[i - begin] = distance[s[i]][s[i + k]];
+  }
+  for (int x = 0; x < end - begin; x++) {
+    delta[x] = (cross[x] + cross[x + 1]) - (edge[begin + x] + edge[begin + x + k]);
   }
 
-  if (bestMove->I != bestMove->J) {
-    std::reverse(&s[bestMove->I + 1], &s[bestMove->J + 1]);
-    count++;
+  for (int i = begin; i < end; i++) {
+    int j = i + k;
+
+    double crossDelta = delta[i - begin];
+    int pairPosI = positions[instance[s[i + 1]]->pair];
+    int pairPosJ = positions[instance[s[j]]->pair];
+    bool pairIinside = (!allowInfeasible && (pairPosI > i && pairPosI <= j));
+    bool pairJinside = (!allowInfeasible && (pairPosJ > i && pairPosJ <= j));
+
+    // cur = [i, j], down = [i + 1, j], left = [i, j - 1], inner = [i + 1, j - 1]
+    k2opmem* cur = K2MEM(i, k);
+    k2opmem* down = K2MEM(i + 1, k - 1);
+    k2opmem* left = K2MEM(i, k - 1);
+    int inner = 2 * K2CELL(i + 1, k - 2);
+    int cell = K2CELL(i, k);
+
+    if (pairIinside || pairJinside) {
+      cur[1] = Best(down[1], left[1]);
+      cur[0] = k2opmem(cell, inner + 1, mem[inner + 1].cost + crossDelta);
+      k2opmem& a = (pairIinside) ? infk2 : down[0];
+      k2opmem& b = (pairJinside) ? infk2 : left[0];
+      cur[0] = Best(cur[0], Best(a, b));
+    } else {
+      k2opmem Tc_fw = k2opmem(cell, inner, mem[inner].cost + crossDelta);
+      k2opmem Tc_bw = k2opmem(cell, inner + 1, mem[inner + 1].cost + crossDelta);
+
+      cur[1] = Best(Tc_fw, Best(down[1], left[1]));
+      cur[0] = Best(Tc_bw, Best(down[0], left[0]));
+    }
   }
 }
 
 PDP2koptMove::PDP2koptMove(bool allowInfeasible) {
   this->allowInfeasible = allowInfeasible;
-  visited = new bool[Application::instance->Size()];
-  positions = new int[Application::instance->Size()];
+  positions = nullptr;
   count2opt = 0;
   totalCount2opt = 0;
 
   int n = Application::instance->Size();
 
-  mem = new k2opmem**[n];
-  for (int i = 0; i < n; i++) {
-    mem[i] = new k2opmem*[n];
-    for (int j = 0; j < n; j++) {
-      mem[i][j] = new k2opmem[2];
-    }
+  // reversals longer than --2kopt-len are not stored, giving O(n.L) time and memory
+  band = n - 1;
+  if (Application::k2opt_len > 0 && Application::k2opt_len < band) band = Application::k2opt_len;
+
+  size_t cells = 0;
+  diagonal = new int[band + 1];
+  for (int d = 0; d <= band; d++) {
+    diagonal[d] = (int)cells;
+    cells += n - d;
   }
+  mem = new k2opmem[2 * cells];
+
+  edge = new double[n];
+  scratch = nullptr;
+  scratchThreads = 0;
 }
 
-PDP2koptMove::~PDP2koptMove() {
-  delete[] visited;
-  delete[] positions;
+void PDP2koptMove::Scratch(int threads) {
+  if (threads <= scratchThreads) return;
 
   int n = Application::instance->Size();
-  for (int i = 0; i < n; i++) {
-    for (int j = 0; j < n; j++)
-      delete[] mem[i][j];
-    delete[] mem[i];
-  }
+  delete[] scratch;
+  scratch = new double[(size_t)threads * 2 * (n + 1)];
+  scratchThreads = threads;
+}
+
+PDP2koptMove::~PDP2koptMove() {
+  delete[] diagonal;
   delete[] mem;
+  delete[] edge;
+  delete[] scratch;
 }
 
 PDPMoveEvaluation PDP2koptMove::Evaluate(PDPSolution*, PDPNode*) {
@@ -68,38 +136,41 @@ PDPMoveEvaluation PDP2koptMove::Evaluate(PDPSolution*, PDPNode*) {
   return eval;
 }
 
-k2opmem k2inf(0, 0, 0, DBL_MAX);
-
 PDPMoveEvaluation PDP2koptMove::Evaluate(PDPSolution* solution) {
   PDPMoveEvaluation eval;
   eval.neighborhood = this;
 
+  if (!allowInfeasible && IsLocalOptimum(solution)) {
+    eval.moveparam = 0;
+    return eval;
+  }
+
   PDPRoute* r = &solution->route;
   int n = r->size() - 1;
   int* s = r->data();
-  for (int i = 0; i < n; i++) {
-    positions[s[i]] = i;
-  }
+  positions = PDPPrecedenceIndex::Get(solution).Positions();
 
   PDPNode** instance = (PDPNode**)(Application::instance->Data());
   double** distance = Application::instance->Distances();
 
+  const int L = std::min(band, n - 1);
+
   // Base case to i == j
   for (int i = 0; i < n; i++) {
     bool ispair = instance[s[i]]->pair == s[i + 1];
     bool ispairRev = ispair && instance[s[i]]->isDelivery;
 
-    const int j = i;
-    mem[i][j][1] = k2opmem(0, 0, 0, 0);
-    mem[i][j][0] = (!allowInfeasible && ispair) ? k2opmem(0, 0, 0, DBL_MAX) : k2opmem(0, 0, 0, 0);
+    k2opmem* cur = K2MEM(i, 0);
+    cur[1] = k2opmem(-1, -1, 0);
+    cur[0] = (!allowInfeasible && ispair) ? k2opmem(-1, -1, DBL_MAX) : k2opmem(-1, -1, 0);
 
     if (ispairRev) {
-      std::swap(mem[i][j][1], mem[i][j][0]);
+      std::swap(cur[1], cur[0]);
     }
   }
 
   // Base case to j - i == 1;
-  for (int i = 0; i < n - 1; i++) {
+  for (int i = 0; L >= 1 && i < n - 1; i++) {
     const int j = i + 1;
     bool ispair = instance[s[i]]->pair == s[i + 1] || instance[s[j]]->pair == s[j + 1] ||
                   instance[s[i]]->pair == s[j + 1];
@@ -107,50 +178,66 @@ PDPMoveEvaluation PDP2koptMove::Evaluate(PDPSolution* solution) {
                      (instance[s[j]]->pair == s[j + 1] && instance[s[j]]->isDelivery) ||
                      (instance[s[i]]->pair == s[j + 1] && instance[s[i]]->isDelivery);
 
-    mem[i][j][1] = k2opmem(0, 0, 0, 0);
-    mem[i][j][0] = (!allowInfeasible && ispair) ? k2opmem(0, 0, 0, DBL_MAX) : k2opmem(0, 0, 0, 0);
+    k2opmem* cur = K2MEM(i, 1);
+    cur[1] = k2opmem(-1, -1, 0);
+    cur[0] = (!allowInfeasible && ispair) ? k2opmem(-1, -1, DBL_MAX) : k2opmem(-1, -1, 0);
 
     if (ispairRev) {
-      std::swap(mem[i][j][1], mem[i][j][0]);
+      std::swap(cur[1], cur[0]);
     }
   }
 
-  for (int k = 2; k < n; k++) {
-    for (int i = 0; i < n - k; i++) {
-      int j = i + k;
-
-      double crossDelta = distance[s[i]][s[j]] + distance[s[i + 1]][s[j + 1]] -
-                          (distance[s[i]][s[i + 1]] + distance[s[j]][s[j + 1]]);
-      int pairPosI = positions[instance[s[i + 1]]->pair];
-      int pairPosJ = positions[instance[s[j]]->pair];
-      bool pairIinside = (!allowInfeasible && (pairPosI > i && pairPosI <= j));
-      bool pairJinside = (!allowInfeasible && (pairPosJ > i && pairPosJ <= j));
-
-      if (pairIinside || pairJinside) {
-        mem[i][j][1] = Best(mem[i + 1][j][1], mem[i][j - 1][1]);
-        mem[i][j][0] = k2opmem(i, j, &mem[i + 1][j - 1][1], mem[i + 1][j - 1][1].cost + crossDelta);
-        k2opmem& a = (pairIinside) ? k2inf : mem[i + 1][j][0];
-        k2opmem& b = (pairJinside) ? k2inf : mem[i][j - 1][0];
-        mem[i][j][0] = Best(mem[i][j][0], Best(a, b));
-      } else {
-        k2opmem Tc_fw = k2opmem(i, j, &mem[i + 1][j - 1][0], mem[i + 1][j - 1][0].cost + crossDelta);
-        k2opmem Tc_bw = k2opmem(i, j, &mem[i + 1][j - 1][1], mem[i + 1][j - 1][1].cost + crossDelta);
-
-        mem[i][j][1] = Best(Tc_fw, Best(mem[i + 1][j][1], mem[i][j - 1][1]));
-        mem[i][j][0] = Best(Tc_bw, Best(mem[i + 1][j][0], mem[i][j - 1][0]));
+  for (int i = 0; i < n; i++) {
+    edge[i] = distance[s[i]][s[i + 1]];
+  }
+
+  int k = 2;
+  ThreadPool* pool = (n >= K2OPT_PARALLEL_MIN_NODES) ? ThreadPool::Shared() : nullptr;
+  Scratch((pool != nullptr) ? pool->Size() : 1);
+  if (pool != nullptr && std::min(L, n - pool->Size()) >= 2) {
+    // wavefront: each thread sweeps its share of every diagonal and only waits for its two
+    // neighbours, since cell (i, i + k) reads cells i and i + 1 of the two previous diagonals
+    const int T = pool->Size();
+    const int last = std::min(L, n - T);
+    std::vector<std::atomic<int>> done(T);
+    for (int t = 0; t < T; t++) done[t].store(1);
+
+    bool ran = pool->Run([&](int t) {
+      double* scratch = this->scratch + (size_t)t * 2 * (n + 1);
+      for (int d = 2; d <= last; d++) {
+        while ((t > 0 && done[t - 1].load(std::memory_order_acquire) < d - 1) ||
+               (t + 1 < T && done[t + 1].load(std::memory_order_acquire) < d - 1)) {
+          std::this_thread::yield();
+        }
+
+        ComputeDiagonal(s, d, t * (n - d) / T, (t + 1) * (n - d) / T, scratch);
+        done[t].store(d, std::memory_order_release);
       }
-    }
+    });
+    if (ran) k = last + 1;
   }
 
-  k2opmem& Tbest = mem[0][n - 1][1];
+  for (; k <= L; k++) {
+    ComputeDiagonal(s, k, 0, n - k, scratch);
+  }
+
+  // wider intervals only keep the best of their sub-intervals
+  k2opmem* Tbest = &K2MEM(0, L)[1];
+  for (int i = 1; i + L < n; i++) {
+    if (K2MEM(i, L)[1].cost < Tbest->cost) Tbest = &K2MEM(i, L)[1];
+  }
 
-  if (Tbest.I == Tbest.J) {
-    Tbest.cost = DBL_MAX;
+  if (Tbest->cell < 0) {
+    Tbest->cost = DBL_MAX;
   }
 
-  eval.cost = solution->cost + Tbest.cost;
-  eval.moveparam = &Tbest;
+  // one unit per cell of the band, whatever the number of threads
+  Work::Add((uint64_t)(L + 1) * n - (uint64_t)L * (L + 1) / 2);
+
+  eval.cost = solution->cost + Tbest->cost;
+  eval.moveparam = Tbest;
 
+  if (!allowInfeasible) UpdateLocalOptimum(solution, eval);
   return eval;
 }
 
@@ -175,7 +262,7 @@ double PDP2koptMove::move(PDPSolution* solution, const PDPMoveEvaluation& eval)
   PDPRoute* r = &solution->route;
 
   int count = 0;
-  ApplyK2opt(r->data(), Tbest, count);
+  ApplyK2opt(r->data(), (int)(Tbest - mem), count);
   count2opt += count;
   totalCount2opt += count;
 
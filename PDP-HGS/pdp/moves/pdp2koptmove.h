@@ -25,21 +25,25 @@ SOFTWARE.*/
 
 #include "pdp/moves/pdpmove.h"
 
+//! Route size from which the 2k-opt table is filled by all --threads.
+#define K2OPT_PARALLEL_MIN_NODES 500
+
 namespace pdp {
 namespace moves {
 
 typedef struct _k2opmem {
-    int I;
-    int J;
-    _k2opmem* next;
+    //! Cost delta of the reversal chain.
     double cost;
-    _k2opmem() : _k2opmem(0, 0, 0, 0) {
+    //! Table cell of the outermost reversal (-1 for no reversal).
+    int cell;
+    //! Table entry of the nested reversal chain (-1 for none).
+    int next;
+    _k2opmem() : _k2opmem(-1, -1, 0) {
     }
 
-    _k2opmem(int I, int J, _k2opmem* next, double cost) {
+    _k2opmem(int cell, int next, double cost) {
       this->cost = std::min(cost, (double)DBL_MAX);
-      this->I = I;
-      this->J = J;
+      this->cell = cell;
       this->next = next;
     }
 
@@ -78,9 +82,39 @@ class PDP2koptMove : public PDPMove {
     virtual size_t ResetCount();
 
   private:
-    bool* visited;
-    int* positions;
-    k2opmem*** mem;
+    //! Apply a reversal chain stored in the table, innermost reversal first.
+    //! \param s: route to be modified.
+    //! \param entry: table entry of the chain.
+    //! \param count: incremented for each applied reversal.
+    void ApplyK2opt(int* s, int entry, int& count) const;
+
+    //! Fill cells [begin, end) of diagonal k, diagonals k - 1 and k - 2 must be complete.
+    //! \param s: route being evaluated.
+    //! \param scratch: 2 * (n + 1) doubles owned by the calling thread.
+    void ComputeDiagonal(const int* s, int k, int begin, int end, double* scratch);
+
+    //! Allocate the buffers of ComputeDiagonal on first use, so that the moves can be created
+    //! before the pool is started (e.g. in a process forking its solves).
+    //! \param threads: number of threads filling the table.
+    void Scratch(int threads);
+
+    //! Route index of each node, from the precedence index of the route being evaluated.
+    const int* positions;
+
+    //! Flat DP table: the two entries of cell (i, d = j - i) are stored diagonal by diagonal,
+    //! so each anti-diagonal sweep reads the two previous ones sequentially.
+    k2opmem* mem;
+    //! First cell of each diagonal d in [0, band].
+    int* diagonal;
+    //! Maximum reversal length (j - i) stored in the table.
+    int band;
+    //! Cost of route edge (s[i], s[i + 1]).
+    double* edge;
+    //! Per-thread buffers of ComputeDiagonal.
+    double* scratch;
+    //! Number of threads the buffers are allocated for.
+    int scratchThreads;
+
     size_t count2opt;
     size_t totalCount2opt;
 
@@ -1,18 +1,18 @@
 #include "pdp2optmove.h"
 
+#include "pdp/pdpprecedenceindex.h"
 #include "pdp/pdproute.h"
 #include "utils/application.h"
+#include "utils/work.h"
 
 using namespace std;
 namespace pdp {
 namespace moves {
 
 PDP2optMove::PDP2optMove() {
-  visited = new bool[Application::instance->Size()];
 }
 
 PDP2optMove::~PDP2optMove() {
-  delete[] visited;
 }
 
 PDPMoveEvaluation PDP2optMove::Evaluate(PDPSolution *solution, PDPNode *pickupNode) {
@@ -27,20 +27,18 @@ PDPMoveEvaluation PDP2optMove::Evaluate(PDPSolution *solution, PDPNode *pickupNo
   int positionPickup = solution->FindPosition(pickupNode->idx);
   int positionDelivery = solution->FindPosition(pickupNode->pair);
   PDPRoute &route = solution->route;
-
-  memset(visited, 0, Application::instance->Size() * sizeof(bool));
-  visited[pickupNode->idx] = true;
+  const PDPPrecedenceIndex &precedence = PDPPrecedenceIndex::Get(solution);
 
   double bestCostDelta = DBL_MAX;
   int bestEnd = 0;
   int bestStart = positionPickup;
-  for (int i = positionPickup + 1; i < positionDelivery; i++) {
+  int work = 0;
+  for (int i = positionPickup + 1; i < positionDelivery; i++, work++) {
     PDPNode *node = nodes[route[i]];
 
     // if its closing a P-D then break... 2opt is now invalid.
-    if (node->isDelivery && visited[node->pair]) break;
-
-    visited[node->idx] = true;
+    int pairPos = precedence.Position(node->pair);
+    if (node->isDelivery && pairPos >= positionPickup && pairPos < i) break;
 
     double costDelta = -distances[route[positionPickup - 1]][route[positionPickup]] -
                        distances[route[i]][route[i + 1]] + distances[route[positionPickup - 1]][route[i]] +
@@ -52,13 +50,11 @@ PDPMoveEvaluation PDP2optMove::Evaluate(PDPSolution *solution, PDPNode *pickupNo
     }
   }
 
-  memset(visited, 0, Application::instance->Size() * sizeof(bool));
-  for (size_t i = positionDelivery + 1; i < route.size() - 1; i++) {
+  for (size_t i = positionDelivery + 1; i < route.size() - 1; i++, work++) {
     PDPNode *node = nodes[route[i]];
 
-    if (node->isDelivery && visited[node->pair]) break;
-
-    visited[node->idx] = true;
+    int pairPos = precedence.Position(node->pair);
+    if (node->isDelivery && pairPos > positionDelivery && pairPos < (int)i) break;
 
     double costDelta = -distances[route[positionDelivery - 1]][route[positionDelivery]] -
                        distances[route[i]][route[i + 1]] + distances[route[positionDelivery - 1]][route[i]] +
@@ -71,6 +67,8 @@ PDPMoveEvaluation PDP2optMove::Evaluate(PDPSolution *solution, PDPNode *pickupNo
     }
   }
 
+  Work::Add(work);
+
   if (bestCostDelta < DBL_MAX) {
     state.originPickup = positionPickup;
     state.originDelivery = positionDelivery;
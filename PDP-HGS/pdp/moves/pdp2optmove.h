@@ -62,7 +62,6 @@ class PDP2optMove : public PDPMove {
     virtual double move(PDPSolution* solution, const PDPMoveEvaluation& eval);
 
   private:
-    bool* visited;
     PDP2optMoveState state;
 };
 
@@ -1,7 +1,13 @@
 #include "pdp4optmove.h"
 
+#include <algorithm>
+
+#include "pdp/pdpinstance.h"
+#include "pdp/pdpprecedenceindex.h"
 #include "pdp/pdproute.h"
 #include "utils/application.h"
+#include "utils/threadpool.h"
+#include "utils/work.h"
 
 using namespace std;
 namespace pdp {
@@ -11,23 +17,50 @@ PDP4optMove::PDP4optMove(bool allowInfeasible) {
   this->allowInfeasible = allowInfeasible;
   int instanceSize = Application::instance->Size();
 
-  customerPosition.resize(instanceSize);
-  subrouteInfo.resize(instanceSize + 1);
-  for (size_t i = 0; i < subrouteInfo.size(); i++) {
-    subrouteInfo[i].resize(subrouteInfo.size());
-  }
+  precedence = nullptr;
 
   oldSol = new int[instanceSize + 1];
   sol = new int[instanceSize + 1];
 
-  cost = new double *[instanceSize];
+  // rows i in [0, n - 3] hold the pairs j in [i + 2, n - 1]
+  cost = Application::opt4_granular ? nullptr : new double_pair[(size_t)instanceSize * instanceSize / 2 + 1];
+  costRow = new size_t[instanceSize];
+  edge = new double[instanceSize];
   best_reach = new double_pair[instanceSize];
   best_cross = new double_pair[instanceSize];
   pred_reach = new int_pair[instanceSize];
   pred_cross = new ac_pair[instanceSize];
 
-  for (int i = 0; i < instanceSize; i++) {
-    cost[i] = new double[instanceSize];
+  reachTree[0] = reachTree[1] = nullptr;
+  candidateRow = nullptr;
+  reachLeaves = 0;
+
+  if (Application::opt4_granular) {
+    // symmetric k nearest neighbors lists
+    const std::vector<std::vector<int>> &closest = ((PDPInstance *)Application::instance)->closest;
+    int k = std::min(Application::opt4_granular, instanceSize - 1);
+    std::vector<std::vector<int>> neighbors(instanceSize);
+    for (int u = 0; u < instanceSize; u++) {
+      for (int x = 0; x < k; x++) {
+        int v = closest[u][x];
+        neighbors[u].push_back(v);
+        neighbors[v].push_back(u);
+      }
+    }
+
+    candidateStart.push_back(0);
+    for (int u = 0; u < instanceSize; u++) {
+      std::sort(neighbors[u].begin(), neighbors[u].end());
+      neighbors[u].erase(std::unique(neighbors[u].begin(), neighbors[u].end()), neighbors[u].end());
+      candidates.insert(candidates.end(), neighbors[u].begin(), neighbors[u].end());
+      candidateStart.push_back((int)candidates.size());
+    }
+
+    reachLeaves = 1;
+    while (reachLeaves < instanceSize + 1) reachLeaves *= 2;
+    reachTree[0] = new int[2 * reachLeaves];
+    reachTree[1] = new int[2 * reachLeaves];
+    candidateRow = new int[instanceSize + 1];
   }
 
   countDD = 0;
@@ -39,15 +72,16 @@ PDP4optMove::PDP4optMove(bool allowInfeasible) {
 }
 
 PDP4optMove::~PDP4optMove() {
-  int instanceSize = Application::instance->Size();
-  for (int i = 0; i < instanceSize; i++) {
-    delete[] cost[i];
-  }
   delete[] pred_cross;
   delete[] pred_reach;
   delete[] best_reach;
   delete[] best_cross;
   delete[] cost;
+  delete[] costRow;
+  delete[] edge;
+  delete[] reachTree[0];
+  delete[] reachTree[1];
+  delete[] candidateRow;
   delete[] sol;
   delete[] oldSol;
 }
@@ -79,64 +113,26 @@ const char *PDP4optMove::ExtraInfo() const {
   }
 }
 
-void PDP4optMove::Precompute(PDPRoute *r) {
-  register PDPNode **nodes = static_cast<PDPNode **>(Application::instance->Data());
-
-  PDPRoute &route = *r;
-  int sz = route.size();
-
-  for (int i = 0; i < sz; i++) {
-    customerPosition[route[i]] = i;
-  }
-
-  // subroute infos
-  for (int i = 0; i < sz; i++) {
-    SubrouteInfo info;
-    PickupDeliveryInfo *pRange;
-    info.reversible = true;
-
-    for (int j = i; j < sz; j++) {
-      PDPNode &node = *nodes[route[j]];
-
-      if (node.idx != 0) {
-        int &pairPos = customerPosition[node.pair];
-
-        if (pairPos >= i && pairPos <= j) {
-          info.reversible = false;
-        } else {
-          if (pairPos < i) {
-            pRange = &info.before;
-
-            if (node.isDelivery) {
-              if (pRange->early > pairPos || pRange->early == -1) pRange->early = pairPos;
-              if (pRange->later < pairPos) pRange->later = pairPos;
-            }
-          }
-        }
-      }
-      subrouteInfo[i][j] = info;
-    }
-  }
-}
+#define AC(i, j) cost[costRow[i] + (j)]
 
-#define validateCC(i1, j1) (!allowInfeasible && subrouteInfo[i1 + 1][j1].reversible)
+#define validateCC(i1, j1) (!allowInfeasible && precedence->Reversible(i1 + 1, j1))
 
 #define validateDD(i1, j1, i2, j2)                                                                \
-  (allowInfeasible || (Application::ls_4opt_dd && (subrouteInfo[i2 + 1][j2].before.later <= i1 && \
-                                                   subrouteInfo[j1 + 1][j2].before.later <= i1)))
+  (allowInfeasible || (Application::ls_4opt_dd && (precedence->Later(i2 + 1, j2) <= i1 && \
+                                                   precedence->Later(j1 + 1, j2) <= i1)))
 
 #define validateCD(i1, j1, i2, j2)                                                                \
-  (!allowInfeasible && (Application::ls_4opt_cd && subrouteInfo[i2 + 1][j2].before.later <= i1 && \
-                        subrouteInfo[i2 + 1][j1].reversible && subrouteInfo[j1 + 1][j2].reversible))
+  (!allowInfeasible && (Application::ls_4opt_cd && precedence->Later(i2 + 1, j2) <= i1 && \
+                        precedence->Reversible(i2 + 1, j1) && precedence->Reversible(j1 + 1, j2)))
 
 #define validateDC(i1, j1, i2, j2)                                                                \
-  (!allowInfeasible && (Application::ls_4opt_dc && subrouteInfo[j1 + 1][j2].before.later <= i1 && \
-                        subrouteInfo[i1 + 1][i2].reversible && subrouteInfo[i2 + 1][j1].reversible))
+  (!allowInfeasible && (Application::ls_4opt_dc && precedence->Later(j1 + 1, j2) <= i1 && \
+                        precedence->Reversible(i1 + 1, i2) && precedence->Reversible(i2 + 1, j1)))
 
 #define SimpleTerminalNodeUpdate                   \
   {                                                \
-    if (cost[i][j] < best_t && validateCC(i, j)) { \
-      best_t = cost[i][j];                         \
+    if (AC(i, j).c < best_t && validateCC(i, j)) { \
+      best_t = AC(i, j).c;                         \
       pred_t[1].i = i;                             \
       pred_t[1].j = j;                             \
       type[0] = 0;                                 \
@@ -149,9 +145,9 @@ void PDP4optMove::Precompute(PDPRoute *r) {
 #define BestTerminalNodeUpdate                                            \
   {                                                                       \
     /* y=d  and  x=d */                                                   \
-    if ((cost[j][i] + best_cross[j - 1].d) < best_t &&                    \
+    if ((AC(i, j).d + best_cross[j - 1].d) < best_t &&                    \
         validateDD(pred_cross[j - 1].d.i, pred_cross[j - 1].d.j, i, j)) { \
-      best_t = cost[j][i] + best_cross[j - 1].d;                          \
+      best_t = AC(i, j).d + best_cross[j - 1].d;                          \
       pred_t[0] = pred_cross[j - 1].d;                                    \
       pred_t[1].i = i;                                                    \
       pred_t[1].j = j;                                                    \
@@ -162,9 +158,9 @@ void PDP4optMove::Precompute(PDPRoute *r) {
     }                                                                     \
                                                                           \
     /* y=c and x=d  */                                                    \
-    if ((cost[j][i] + best_cross[j - 1].c) < best_t &&                    \
+    if ((AC(i, j).d + best_cross[j - 1].c) < best_t &&                    \
         validateCD(pred_cross[j - 1].c.i, pred_cross[j - 1].c.j, i, j)) { \
-      best_t = cost[j][i] + best_cross[j - 1].c;                          \
+      best_t = AC(i, j).d + best_cross[j - 1].c;                          \
       pred_t[0] = pred_cross[j - 1].c;                                    \
       pred_t[1].i = i;                                                    \
       pred_t[1].j = j;                                                    \
@@ -175,9 +171,9 @@ void PDP4optMove::Precompute(PDPRoute *r) {
     }                                                                     \
                                                                           \
     /* y=d and x=c */                                                     \
-    if ((cost[i][j] + best_cross[j - 1].d) < best_t &&                    \
+    if ((AC(i, j).c + best_cross[j - 1].d) < best_t &&                    \
         validateDC(pred_cross[j - 1].d.i, pred_cross[j - 1].d.j, i, j)) { \
-      best_t = cost[i][j] + best_cross[j - 1].d;                          \
+      best_t = AC(i, j).c + best_cross[j - 1].d;                          \
       pred_t[0] = pred_cross[j - 1].d;                                    \
       pred_t[1].i = i;                                                    \
       pred_t[1].j = j;                                                    \
@@ -190,13 +186,13 @@ void PDP4optMove::Precompute(PDPRoute *r) {
 
 #define BestReachUpdate                 \
   {                                     \
-    if (cost[i][j] < best_reach[j].c) { \
-      best_reach[j].c = cost[i][j];     \
+    if (AC(i, j).c < best_reach[j].c) { \
+      best_reach[j].c = AC(i, j).c;     \
       pred_reach[j].c = i;              \
     }                                   \
                                         \
-    if (cost[j][i] < best_reach[j].d) { \
-      best_reach[j].d = cost[j][i];     \
+    if (AC(i, j).d < best_reach[j].d) { \
+      best_reach[j].d = AC(i, j).d;     \
       pred_reach[j].d = i;              \
     }                                   \
   }
@@ -252,9 +248,9 @@ double PDP4optMove::connectSegmentsDelta(const int *sol, const int *a, const int
 
 #define checkCombinations                                                                 \
                                                                                           \
-  int bMax = subrouteInfo[blkB[0]][blkB[1]].reversible ? 2 : 1;                           \
-  int cMax = subrouteInfo[blkC[0]][blkC[1]].reversible ? 2 : 1;                           \
-  int dMax = subrouteInfo[blkD[0]][blkD[1]].reversible ? 2 : 1;                           \
+  int bMax = precedence->Reversible(blkB[0], blkB[1]) ? 2 : 1;                            \
+  int cMax = precedence->Reversible(blkC[0], blkC[1]) ? 2 : 1;                            \
+  int dMax = precedence->Reversible(blkD[0], blkD[1]) ? 2 : 1;                            \
                                                                                           \
   for (int b = 0; b < bMax; b++) {                                                        \
     const int *B = b ? blkb : blkB;                                                       \
@@ -275,13 +271,13 @@ double PDP4optMove::connectSegmentsDelta(const int *sol, const int *a, const int
 double PDP4optMove::bestFromDD(const int *sol, int blks[][2], double removedEdgesDelta, double bestKnown) {
   // check this configuration violates the precedence rule?
   if (!(allowInfeasible ||
-        (Application::ls_4opt_dd && (subrouteInfo[blks[2][0] + 1][blks[6][0]].before.later <= blks[0][1] &&
-                                     subrouteInfo[blks[4][0] + 1][blks[6][0]].before.later <= blks[0][1]))))
+        (Application::ls_4opt_dd && (precedence->Later(blks[2][0] + 1, blks[6][0]) <= blks[0][1] &&
+                                     precedence->Later(blks[4][0] + 1, blks[6][0]) <= blks[0][1]))))
     return bestKnown;
 
-  int bMax = subrouteInfo[blks[5][0]][blks[5][1]].reversible ? 2 : 1;
-  int cMax = subrouteInfo[blks[3][0]][blks[3][1]].reversible ? 2 : 1;
-  int dMax = subrouteInfo[blks[1][0]][blks[1][1]].reversible ? 2 : 1;
+  int bMax = precedence->Reversible(blks[5][0], blks[5][1]) ? 2 : 1;
+  int cMax = precedence->Reversible(blks[3][0], blks[3][1]) ? 2 : 1;
+  int dMax = precedence->Reversible(blks[1][0], blks[1][1]) ? 2 : 1;
 
   for (int b = 0; b < bMax; b++) {
     const int *B = blks[5 + b];
@@ -305,12 +301,12 @@ double PDP4optMove::bestFromDD(const int *sol, int blks[][2], double removedEdge
 double PDP4optMove::bestFromCD(const int *sol, int blks[][2], double removedEdgesDelta, double bestKnown) {
   // check this configuration violates the precedence rule?
   if (!(allowInfeasible ||
-        (Application::ls_4opt_cd && subrouteInfo[blks[3][0]][blks[6][0]].before.later <= blks[0][1])))
+        (Application::ls_4opt_cd && precedence->Later(blks[3][0], blks[6][0]) <= blks[0][1])))
     return bestKnown;
 
-  int bMax = subrouteInfo[blks[3][0]][blks[3][1]].reversible ? 2 : 1;
-  int cMax = subrouteInfo[blks[5][0]][blks[5][1]].reversible ? 2 : 1;
-  int dMax = subrouteInfo[blks[1][0]][blks[1][1]].reversible ? 2 : 1;
+  int bMax = precedence->Reversible(blks[3][0], blks[3][1]) ? 2 : 1;
+  int cMax = precedence->Reversible(blks[5][0], blks[5][1]) ? 2 : 1;
+  int dMax = precedence->Reversible(blks[1][0], blks[1][1]) ? 2 : 1;
 
   for (int b = 0; b < bMax; b++) {
     const int *B = blks[3 + b];
@@ -334,12 +330,12 @@ double PDP4optMove::bestFromCD(const int *sol, int blks[][2], double removedEdge
 double PDP4optMove::bestFromDC(const int *sol, int blks[][2], double removedEdgesDelta, double bestKnown) {
   // check this configuration violates the precedence rule?
   if (!(allowInfeasible ||
-        (Application::ls_4opt_dc && subrouteInfo[blks[5][0]][blks[5][1]].before.later <= blks[0][1])))
+        (Application::ls_4opt_dc && precedence->Later(blks[5][0], blks[5][1]) <= blks[0][1])))
     return bestKnown;
 
-  int bMax = subrouteInfo[blks[5][0]][blks[5][1]].reversible ? 2 : 1;
-  int cMax = subrouteInfo[blks[1][0]][blks[1][1]].reversible ? 2 : 1;
-  int dMax = subrouteInfo[blks[3][0]][blks[3][1]].reversible ? 2 : 1;
+  int bMax = precedence->Reversible(blks[5][0], blks[5][1]) ? 2 : 1;
+  int cMax = precedence->Reversible(blks[1][0], blks[1][1]) ? 2 : 1;
+  int dMax = precedence->Reversible(blks[3][0], blks[3][1]) ? 2 : 1;
 
   for (int b = 0; b < bMax; b++) {
     const int *B = blks[5 + b];
@@ -375,6 +371,191 @@ double PDP4optMove::best4opt(int *sol, int n, int i1, int j1, int i2, int j2, do
   return bestKnown;
 }
 
+void PDP4optMove::ComputeCostRow(const int *route, int n, int i) {
+  double **distance = Application::instance->Distances();
+  const int prev_i = route[i];
+  const int next_i = route[i + 1];
+  const double *__restrict__ disPrevi = distance[prev_i];
+  const double *__restrict__ disNexti = distance[next_i];
+  const double *__restrict__ edge = this->edge;
+  const int *__restrict__ succ = route + 1;
+  double_pair *__restrict__ row = &AC(i, i + 2);
+  const double edgei = disPrevi[next_i];
+
+  // gathers from two rows only, both halves of the pair are stored side by side
+  for (int j = i + 2, x = 0; j < n; ++j, ++x) {
+    const int prev_j = route[j];
+    const int next_j = succ[j];
+    double deltaR = (edgei + edge[j]);
+    row[x].c = disPrevi[prev_j] + disNexti[next_j] - deltaR;
+    row[x].d = disPrevi[next_j] + disNexti[prev_j] - deltaR;
+  }
+}
+
+// leftmost column with the smallest reach value, -1 for none
+#define BetterReach(a, b, field)                                                                      \
+  (((b) < 0 || ((a) >= 0 && (best_reach[a].field < best_reach[b].field ||                             \
+                            (best_reach[a].field == best_reach[b].field && (a) < (b)))))             \
+       ? (a)                                                                                          \
+       : (b))
+
+#define ReachQuery(tree, l, r, field, res)                                                             \
+  {                                                                                                    \
+    res = -1;                                                                                          \
+    for (int lo = (l) + reachLeaves, hi = (r) + reachLeaves + 1; lo < hi; lo >>= 1, hi >>= 1) {        \
+      if (lo & 1) res = BetterReach(tree[lo], res, field), lo++;                                       \
+      if (hi & 1) --hi, res = BetterReach(tree[hi], res, field);                                       \
+    }                                                                                                  \
+  }
+
+#define ReachUpdate(tree, col, field)                                                                  \
+  {                                                                                                    \
+    for (int x = ((col) + reachLeaves) >> 1; x; x >>= 1) {                                             \
+      tree[x] = BetterReach(tree[2 * x], tree[2 * x + 1], field);                                      \
+    }                                                                                                  \
+  }
+
+void PDP4optMove::EvaluateGranular(const int *route, int n) {
+  double **distance = Application::instance->Distances();
+  const int *positions = precedence->Positions();
+
+  double &best_t = searchState.best_t;
+  AlternatingCycle *pred_t = searchState.pred_t;
+  bool *type = searchState.type;
+  best_t = DBL_MAX;
+
+  // best_reach[j] only holds the cycles (i', j) of finished rows, best_cross[j - 1] of the full
+  // search becomes the best reach over columns [i + 1, j - 1]
+  for (int j = 0; j < reachLeaves; j++) {
+    if (j < n) {
+      best_reach[j].c = best_reach[j].d = DBL_MAX;
+      pred_reach[j].c = pred_reach[j].d = -1;
+    }
+    reachTree[0][reachLeaves + j] = reachTree[1][reachLeaves + j] = (j < n) ? j : -1;
+  }
+  std::fill(candidateRow, candidateRow + n + 1, -1);
+  for (int x = reachLeaves - 1; x; x--) {
+    reachTree[0][x] = BetterReach(reachTree[0][2 * x], reachTree[0][2 * x + 1], c);
+    reachTree[1][x] = BetterReach(reachTree[1][2 * x], reachTree[1][2 * x + 1], d);
+  }
+
+  std::vector<int> columns;
+  std::vector<std::pair<int, double_pair>> reached;
+  uint64_t work = n;
+  for (int i = 0; i < n - 2; i++) {
+    const int prev_i = route[i];
+    const int next_i = route[i + 1];
+    const double *disPrevi = distance[prev_i];
+    const double *disNexti = distance[next_i];
+    const double edgei = disPrevi[next_i];
+
+    // columns j with a candidate among the inserted edges (i, j), (i + 1, j + 1), (i, j + 1), (i + 1, j)
+    columns.clear();
+    for (int end = 0; end < 2; end++) {
+      int u = route[i + end];
+      for (int x = candidateStart[u]; x < candidateStart[u + 1]; x++) {
+        int v = candidates[x];
+        int p = v ? positions[v] : n;
+        for (int j = p - 1; j <= p; j++) {
+          if (j >= i + 2 && j < n && candidateRow[j] != i) {
+            candidateRow[j] = i;
+            columns.push_back(j);
+          }
+        }
+      }
+    }
+    std::sort(columns.begin(), columns.end());
+    work += columns.size();
+
+    reached.clear();
+    for (int j : columns) {
+      const int prev_j = route[j];
+      const int next_j = route[j + 1];
+      double deltaR = (edgei + distance[prev_j][next_j]);
+      double_pair ac;
+      ac.c = disPrevi[prev_j] + disNexti[next_j] - deltaR;
+      ac.d = disPrevi[next_j] + disNexti[prev_j] - deltaR;
+
+      if (i > 0) {
+        int crossC, crossD;
+        ReachQuery(reachTree[0], i + 1, j - 1, c, crossC);
+        ReachQuery(reachTree[1], i + 1, j - 1, d, crossD);
+
+        AlternatingCycle acC = {pred_reach[crossC].c, crossC};
+        AlternatingCycle acD = {pred_reach[crossD].d, crossD};
+        double crossc = best_reach[crossC].c;
+        double crossd = best_reach[crossD].d;
+
+        /* y=d  and  x=d */
+        if (crossd < DBL_MAX && (ac.d + crossd) < best_t && validateDD(acD.i, acD.j, i, j)) {
+          best_t = ac.d + crossd;
+          pred_t[0] = acD;
+          pred_t[1].i = i;
+          pred_t[1].j = j;
+          type[0] = 1;
+          type[1] = 1;
+          searchState.segments.n = 0;
+          searchState.segments.type = MOVE_DD;
+        }
+
+        /* y=c and x=d  */
+        if (crossc < DBL_MAX && (ac.d + crossc) < best_t && validateCD(acC.i, acC.j, i, j)) {
+          best_t = ac.d + crossc;
+          pred_t[0] = acC;
+          pred_t[1].i = i;
+          pred_t[1].j = j;
+          type[0] = 1;
+          type[1] = 0;
+          searchState.segments.n = 0;
+          searchState.segments.type = MOVE_CD;
+        }
+
+        /* y=d and x=c */
+        if (crossd < DBL_MAX && (ac.c + crossd) < best_t && validateDC(acD.i, acD.j, i, j)) {
+          best_t = ac.c + crossd;
+          pred_t[0] = acD;
+          pred_t[1].i = i;
+          pred_t[1].j = j;
+          type[0] = 0;
+          type[1] = 1;
+          searchState.segments.n = 0;
+          searchState.segments.type = MOVE_DC;
+        }
+      }
+
+      if (i > 0 || j < n - 1) {
+        if (ac.c < best_t && validateCC(i, j)) {
+          best_t = ac.c;
+          pred_t[1].i = i;
+          pred_t[1].j = j;
+          type[0] = 0;
+          type[1] = 0;
+          searchState.segments.n = 0;
+          searchState.segments.type = MOVE_CC;
+        }
+      }
+
+      if (j < n - 1) reached.push_back(std::make_pair(j, ac));
+    }
+
+    // cycles of row i only reach the rows below
+    for (const std::pair<int, double_pair> &cell : reached) {
+      const int j = cell.first;
+      if (cell.second.c < best_reach[j].c) {
+        best_reach[j].c = cell.second.c;
+        pred_reach[j].c = i;
+        ReachUpdate(reachTree[0], j, c);
+      }
+      if (cell.second.d < best_reach[j].d) {
+        best_reach[j].d = cell.second.d;
+        pred_reach[j].d = i;
+        ReachUpdate(reachTree[1], j, d);
+      }
+    }
+  }
+  Work::Add(work);
+}
+
 PDPMoveEvaluation PDP4optMove::Evaluate(PDPSolution * /*solution*/, PDPNode * /*pickupNode*/) {
   PDPMoveEvaluation eval;
   eval.neighborhood = this;
@@ -385,7 +566,16 @@ PDPMoveEvaluation PDP4optMove::Evaluate(PDPSolution * /*solution*/, PDPNode * /*
 }
 
 PDPMoveEvaluation PDP4optMove::Evaluate(PDPSolution *solution) {
-  return Evaluate(solution, false);
+  if (IsLocalOptimum(solution)) {
+    PDPMoveEvaluation eval;
+    eval.neighborhood = this;
+    eval.moveparam = &searchState;
+    return eval;
+  }
+
+  PDPMoveEvaluation eval = Evaluate(solution, false);
+  UpdateLocalOptimum(solution, eval);
+  return eval;
 }
 
 PDPMoveEvaluation PDP4optMove::Evaluate(PDPSolution *solution, bool unfeasible) {
@@ -398,7 +588,7 @@ PDPMoveEvaluation PDP4optMove::Evaluate(PDPSolution *solution, bool unfeasible)
   searchState.segments.n = 0;
 
   PDPRoute *r = &solution->route;
-  Precompute(r);
+  precedence = &PDPPrecedenceIndex::Get(solution);
 
   int *route = sol;
   for (size_t i = 0; i < r->size(); i++) {
@@ -407,27 +597,32 @@ PDPMoveEvaluation PDP4optMove::Evaluate(PDPSolution *solution, bool unfeasible)
 
   int n = r->size() - 1;
 
+  if (!candidates.empty()) {
+    EvaluateGranular(route, n);
+    eval.cost = solution->cost + searchState.best_t;
+    return eval;
+  }
+
   /// Compute 2AC costs
-  int prev_i, next_i, prev_j, next_j;
   double **distance = Application::instance->Distances();
-  register double *costi = nullptr;
+  for (int j = 0; j < n; j++) {
+    edge[j] = distance[route[j]][route[j + 1]];
+  }
 
   // Number of nodes of hamiltonian cycle=n+1; Number of edges will
   // be equal to nodes of hamiltonian cycle -1 (n)
+  size_t offset = 0;
   for (int i = 0; i < n - 2; i++) {
-    prev_i = route[i];
-    next_i = route[i + 1];
-    costi = cost[i];
-    register double *disPrevi = distance[prev_i];
-    register double *disNexti = distance[next_i];
-
-    for (int j = i + 2; n - j; ++j) {
-      prev_j = route[j];
-      next_j = route[j + 1];
-      double deltaR = (disPrevi[next_i] + distance[prev_j][next_j]);
-      costi[j] = disPrevi[prev_j] + disNexti[next_j] - deltaR;
-      cost[j][i] = disPrevi[next_j] + disNexti[prev_j] - deltaR;
-    }
+    costRow[i] = offset - (i + 2);
+    offset += n - 2 - i;
+  }
+
+  ThreadPool *pool = (n >= FOUR_OPT_PARALLEL_MIN_NODES) ? ThreadPool::Shared() : nullptr;
+  if (pool == nullptr || !pool->Run([&](int t) {
+        // interleaved rows balance the triangle between threads
+        for (int i = t; i < n - 2; i += pool->Size()) ComputeCostRow(route, n, i);
+      })) {
+    for (int i = 0; i < n - 2; i++) ComputeCostRow(route, n, i);
   }
 
   double &best_t = searchState.best_t;
@@ -442,8 +637,8 @@ PDPMoveEvaluation PDP4optMove::Evaluate(PDPSolution *solution, bool unfeasible)
   i = 0;
   best_t = DBL_MAX;
   for (j = 2; j < n - 1; j++) {
-    best_reach[j].c = cost[i][j];  // best_reach_c(0,j) = cost_c(0,j)
-    best_reach[j].d = cost[j][i];  // best_reach_d(0,j) = cost_d(0,j)
+    best_reach[j].c = AC(i, j).c;  // best_reach_c(0,j) = cost_c(0,j)
+    best_reach[j].d = AC(i, j).d;  // best_reach_d(0,j) = cost_d(0,j)
     pred_reach[j].c = 0;           // pred_reach_c = 0
     pred_reach[j].d = 0;           // pred_reach_d = 0
     SimpleTerminalNodeUpdate;
@@ -470,16 +665,19 @@ PDPMoveEvaluation PDP4optMove::Evaluate(PDPSolution *solution, bool unfeasible)
     }
   }
 
+  // one unit per alternating cycle (i, j) of the triangle
+  Work::Add((uint64_t)n + (uint64_t)(n - 2) * (n - 1) / 2);
+
   eval.cost = solution->cost + best_t;
   return eval;
 }
 
 #define checkStar(i1, i2, j1, j2, firstImprovement)             \
   {                                                             \
-    ac1d = cost[j1][i1];                                        \
-    ac1c = cost[i1][j1];                                        \
-    ac2d = cost[j2][i2];                                        \
-    ac2c = cost[i2][j2];                                        \
+    ac1d = AC(i1, j1).d;                                        \
+    ac1c = AC(i1, j1).c;                                        \
+    ac2d = AC(i2, j2).d;                                        \
+    ac2c = AC(i2, j2).c;                                        \
                                                                 \
     /* x=d  and  y=d */                                         \
     if ((ac1d + ac2d) < best_t && validateDD(i1, j1, i2, j2)) { \
@@ -25,22 +25,8 @@ SOFTWARE.*/
 
 #include "pdp/moves/pdpmove.h"
 
-typedef struct _PickupDeliveryInfo {
-    int early;
-    int later;
-    _PickupDeliveryInfo() : early(-1), later(-1) {
-    }
-} PickupDeliveryInfo;
-
-typedef struct _SubrouteInfo {
-    PickupDeliveryInfo before;
-    // PickupDeliveryInfo after;
-    bool reversible = true;
-    inline const _SubrouteInfo& operator=(const _SubrouteInfo& o) {
-      std::memcpy(this, &o, sizeof(*this));
-      return *this;
-    }
-} SubrouteInfo;
+//! Route size from which the 2AC cost table is filled by all --threads.
+#define FOUR_OPT_PARALLEL_MIN_NODES 500
 
 struct AlternatingCycle {
     int i;
@@ -89,6 +75,8 @@ typedef struct _PDP4optMoveState {
 } PDP4optMoveState;
 
 namespace pdp {
+class PDPPrecedenceIndex;
+
 namespace moves {
 
 class PDP4optMove : public PDPMove {
@@ -140,11 +128,34 @@ class PDP4optMove : public PDPMove {
     double bestFromDC(const int* sol, int blks[][2], double removedEdgesDelta, double bestKnown);
     double bestFromCD(const int* sol, int blks[][2], double removedEdgesDelta, double bestKnown);
 
-    void Precompute(pdp::PDPRoute* route);
+    //! Fill row i of the 2AC cost table.
+    //! \param route: route being evaluated.
+    //! \param n: number of route edges.
+    void ComputeCostRow(const int* route, int n, int i);
+
+    //! O(n.k.log n) search restricted to the alternating cycles inserting at least one candidate edge.
+    //! \param route: route being evaluated.
+    //! \param n: number of route edges.
+    void EvaluateGranular(const int* route, int n);
 
     int* sol;
     int* oldSol;
-    double** cost;
+    //! Triangular 2AC cost table, AC(i, j).c and AC(i, j).d for i + 2 <= j < n.
+    double_pair* cost;
+    //! Offset of row i in cost (indexed by j).
+    size_t* costRow;
+    //! Cost of route edge (route[j], route[j + 1]).
+    double* edge;
+
+    //! Granular candidate neighbors of each node (CSR), empty for the full neighborhood.
+    std::vector<int> candidateStart;
+    std::vector<int> candidates;
+    //! Columns with the best reaching cycle of a column range, for c and d cycles.
+    int* reachTree[2];
+    //! Size of the tree leaf level.
+    int reachLeaves;
+    //! Last row each column was listed for.
+    int* candidateRow;
 
     double_pair* best_reach;
     double_pair* best_cross;
@@ -159,8 +170,8 @@ class PDP4optMove : public PDPMove {
     size_t countTotalCD;
 
     PDP4optMoveState searchState;
-    std::vector<int> customerPosition;
-    std::vector<std::vector<SubrouteInfo>> subrouteInfo;
+    //! Precedence index of the route being evaluated.
+    const PDPPrecedenceIndex* precedence;
     bool allowInfeasible;
 };
 
@@ -2,6 +2,9 @@
 
 #include "pdp/pdproute.h"
 #include "utils/application.h"
+#include "utils/threadpool.h"
+
+#define BS_PARALLEL_MIN_NODES 500
 
 using namespace std;
 namespace pdp {
@@ -10,7 +13,7 @@ namespace moves {
 PDPBsMove::PDPBsMove() {
   routeToWork = new int[Application::instance->Size() + 2];
   bs = new BSGraph(Application::bs_k, Application::instance->Size(), Application::instance->Distances(),
-                   (clock_t)-1, (size_t)-1);
+                   (clock_t)-1, (size_t)Application::bs_cache_mb << 20);
 
   state.changedroute.reserve(Application::instance->Size() + 2);
 }
@@ -25,11 +28,34 @@ PDPMoveEvaluation PDPBsMove::Evaluate(PDPSolution *solution) {
   eval.cost = DBL_MAX;
   eval.neighborhood = this;
   eval.moveparam = &state;
+
+  if (IsLocalOptimum(solution)) {
+    // B&S draws its cache double-check on every call: keep the random stream aligned
+    rand();
+    return eval;
+  }
+
   state.updatedcost = DBL_MAX;
   state.changedroute = solution->route;
-  bs->updateOrder(state.changedroute, state.updatedcost);
+
+  int nWindows = Application::bs_window ? Windows(solution) : -1;
+  ThreadPool *pool = (Application::bs_parallel && (int)state.changedroute.size() >= BS_PARALLEL_MIN_NODES)
+                         ? ThreadPool::Shared()
+                         : nullptr;
+  if (nWindows < 0 && pool != nullptr) {
+    // the blocks do not use the cache double-check: keep the random stream aligned
+    rand();
+    bs->updateOrderBlocks(state.changedroute, state.updatedcost, pool);
+  } else if (nWindows < 0) {
+    bs->updateOrder(state.changedroute, state.updatedcost);
+  } else {
+    // windowed mode: each window is reordered in place, so the results are stitched together
+    for (int w = 0; w < nWindows; w++)
+      bs->updateOrder(state.changedroute, state.updatedcost, windowBegin[w], windowEnd[w]);
+  }
   eval.cost = state.updatedcost;
 
+  UpdateLocalOptimum(solution, eval);
   return eval;
 }
 
@@ -55,6 +81,48 @@ double PDPBsMove::move(PDPSolution *solution, const PDPMoveEvaluation &eval) {
   return PDPMove::move(solution, eval);
 }
 
+const char *PDPBsMove::ExtraTotalInfo() const {
+  const BSCache *cache = bs->cache;
+  if (cache != nullptr && cache->queries) {
+    sprintf((char *)extraInfoBuffer, "hit=%zu;mis=%zu;imp=%zu;evc=%zu", cache->hits,
+            cache->queries - cache->hits, cache->improvements, cache->evictions);
+    return extraInfoBuffer;
+  } else {
+    return 0;
+  }
+}
+
+int PDPBsMove::Windows(const PDPSolution *solution) {
+  int nRanges = ChangedRangesSinceLocalOptimum(solution, windowBegin, windowEnd);
+  if (nRanges < 0) return -1;
+
+  // padding the changed ranges by k and merging the overlapping ones
+  int first = 1, last = (int)solution->route.size() - 2;
+  for (int r = 0; r < nRanges; r++) {
+    windowBegin[r] = max(first, windowBegin[r] - Application::bs_k);
+    windowEnd[r] = min(last, windowEnd[r] + Application::bs_k);
+  }
+  for (int r = 1; r < nRanges; r++) {
+    for (int s = r; s > 0 && windowBegin[s] < windowBegin[s - 1]; s--) {
+      swap(windowBegin[s], windowBegin[s - 1]);
+      swap(windowEnd[s], windowEnd[s - 1]);
+    }
+  }
+
+  int nWindows = 0;
+  for (int r = 0; r < nRanges; r++) {
+    if (windowBegin[r] > windowEnd[r]) continue;
+    if (nWindows > 0 && windowBegin[r] <= windowEnd[nWindows - 1] + 1) {
+      windowEnd[nWindows - 1] = max(windowEnd[nWindows - 1], windowEnd[r]);
+    } else {
+      windowBegin[nWindows] = windowBegin[r];
+      windowEnd[nWindows] = windowEnd[r];
+      nWindows++;
+    }
+  }
+  return nWindows;
+}
+
 std::string PDPBsMove::name() const {
   return "pdp-b&s";
 }
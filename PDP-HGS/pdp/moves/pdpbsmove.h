@@ -60,10 +60,22 @@ class PDPBsMove : public PDPMove {
     //! \return double: New Solution cost after local search move.
     virtual double move(PDPSolution* solution, const PDPMoveEvaluation& eval);
 
+    //! Cache statistics (hits, misses, improving hits and evictions), if the cache is enabled.
+    virtual const char* ExtraTotalInfo() const;
+
   private:
+    //! Compute the windows changed since the last local optimum (padded by k and merged).
+    //! \param solution: current Solution representation.
+    //! \return int: number of windows, or -1 if the whole route has to be reordered.
+    int Windows(const PDPSolution* solution);
+
     int* routeToWork;
     PDPBsMoveState state;
 
+    //! Windows of the windowed mode (sorted and disjoint).
+    int windowBegin[DIRTY_HISTORY];
+    int windowEnd[DIRTY_HISTORY];
+
     BSGraph* bs;
 };
 
@@ -28,6 +28,7 @@ SOFTWARE.*/
 
 #include "pdp/moves/pdpmoveevaluation.h"
 #include "pdp/pdpnode.h"
+#include "utils/profiler.h"
 
 namespace pdp {
 namespace moves {
@@ -39,6 +40,7 @@ class PDPMove {
       totalCount = 0;
       count = 0;
       cpuTime = 0.0;
+      optimalVersion = 0;
     }
 
     //! PDPMove destructor.
@@ -87,12 +89,20 @@ class PDPMove {
       return count;
     }
 
+    //! Restore the move counts (checkpoint).
+    void RestoreCount(size_t totalCount, size_t count) {
+      this->totalCount = totalCount;
+      this->count = count;
+    }
+
     virtual size_t ResetCount() {
       size_t ret = count;
       count = 0;
       return ret;
     }
 
+    //! Add evaluation time in milliseconds: steady clock time of a sequential evaluation (the
+    //! threads a move runs included), thread CPU time of a concurrent one.
     void AddCpuTime(double cpuTime) {
       this->cpuTime += cpuTime;
     }
@@ -100,11 +110,50 @@ class PDPMove {
       return cpuTime;
     }
 
+    //! Take the current route as a local optimum of this neighborhood (e.g. a route educated in a previous
+    //! plan), so that the next evaluations only consider the changes made from now on.
+    void SetLocalOptimum(const PDPSolution* solution) {
+      optimalVersion = solution->Version();
+    }
+
+    //! Profile of the evaluations per pickup node (fast) and per route (slow), with --profile.
+    Profile evaluateProfile[2];
+
+    //! Profile of the applied moves, with --profile.
+    Profile applyProfile;
+
+  protected:
+    //! Check if this neighborhood already found no improving move for the current route.
+    //! \param solution: current Solution representation.
+    //! \return bool: true if the route did not change since that evaluation.
+    bool IsLocalOptimum(const PDPSolution* solution) const {
+      return !solution->ChangedSince(optimalVersion);
+    }
+
+    //! Remember the route version when an evaluation found no improving move.
+    //! \param solution: evaluated Solution representation.
+    //! \param eval: evaluation result for the solution.
+    void UpdateLocalOptimum(const PDPSolution* solution, const PDPMoveEvaluation& eval) {
+      if (eval.cost >= solution->cost) optimalVersion = solution->Version();
+    }
+
+    //! Get the route ranges changed since the last evaluation that found no improving move.
+    //! \param solution: current Solution representation.
+    //! \param begins: first route index of each change (room for DIRTY_HISTORY ranges).
+    //! \param ends: last route index of each change (room for DIRTY_HISTORY ranges).
+    //! \return int: number of changes, or -1 if they are not known.
+    int ChangedRangesSinceLocalOptimum(const PDPSolution* solution, int* begins, int* ends) const {
+      return solution->ChangedRangesSince(optimalVersion, begins, ends);
+    }
+
   private:
     double cpuTime;
     size_t count;
     size_t totalCount;
 
+    //! Route version for which the last full evaluation found no improving move.
+    size_t optimalVersion;
+
   protected:
     char extraInfoBuffer[256];
 };
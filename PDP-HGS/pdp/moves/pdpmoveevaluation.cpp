@@ -9,7 +9,10 @@ bool PDPMoveEvaluation::Apply(PDPSolution* solution, bool force) const {
   bool isBestMove = (solution->cost - cost) > 0.01;
 
   if (neighborhood != nullptr && (force || isBestMove)) {
+    int64_t profileStart = Profile::Start();
+    double oldCost = solution->cost;
     neighborhood->move(solution, *this);
+    neighborhood->applyProfile.Stop(profileStart, oldCost - solution->cost);
     return true;
   }
 
@@ -1,14 +1,15 @@
 #include "pdporoptmove.h"
 
+#include "pdp/pdpprecedenceindex.h"
 #include "pdp/pdproute.h"
 #include "utils/application.h"
+#include "utils/work.h"
 
 namespace pdp {
 namespace moves {
 
 PDPOroptMove::PDPOroptMove() : countFast(0), countSlow(0), countTotalFast(0), countTotalSlow(0) {
   numberOfNodes = Application::instance->Size();
-  visited = new bool[numberOfNodes];
   positions = new int[numberOfNodes + 2];
 
   countFast = 0;
@@ -18,7 +19,6 @@ PDPOroptMove::PDPOroptMove() : countFast(0), countSlow(0), countTotalFast(0), co
 }
 
 PDPOroptMove::~PDPOroptMove() {
-  delete[] visited;
   delete[] positions;
 }
 
@@ -60,12 +60,11 @@ PDPMoveEvaluation PDPOroptMove::Evaluate(PDPSolution* solution, PDPNode* pickupN
   PDPRoute* r = &solution->route;
   int n = static_cast<int>(r->size());
 
-  for (size_t i = 0; i < r->size() - 1; i++) {
-    positions[(*r)[i]] = i;
-  }
+  const PDPPrecedenceIndex& precedence = PDPPrecedenceIndex::Get(solution);
 
+  size_t work = 0;
   for (int i = 0; i <= 1; i++) {
-    size_t s = i ? positions[pickupNode->idx] : positions[pickupNode->pair];
+    size_t s = i ? precedence.Position(pickupNode->idx) : precedence.Position(pickupNode->pair);
     bool reversible = true;
 
     PDPNode* node = nodes[(*r)[s]];
@@ -73,23 +72,23 @@ PDPMoveEvaluation PDPOroptMove::Evaluate(PDPSolution* solution, PDPNode* pickupN
     for (size_t e = (Application::ls_relocate ? s + 1 : s); (e < n - 1) && (e - s <= Application::or_k);
          e++) {
       node = nodes[(*r)[e]];
-      reversible = reversible && (node->isPickup || positions[node->pair] < s);
+      reversible = reversible && (node->isPickup || precedence.Position(node->pair) < s);
 
       double removingDelta = distances[(*r)[s - 1]][(*r)[e + 1]] - distances[(*r)[s - 1]][(*r)[s]] -
                              distances[(*r)[e]][(*r)[e + 1]];
 
-      for (size_t pos = s - 1; pos > 0; pos--) {
+      for (size_t pos = s - 1; pos > 0; pos--, work++) {
         node = nodes[(*r)[pos]];
-        posPair = positions[node->pair];
+        posPair = precedence.Position(node->pair);
         if (node->isPickup && posPair >= s && posPair <= e)  // violating precedence
           break;
 
         updateSelectedMove(false);
       }
 
-      for (int pos = e + 2; pos < n; pos++) {
+      for (int pos = e + 2; pos < n; pos++, work++) {
         node = nodes[(*r)[pos - 1]];
-        posPair = positions[node->pair];
+        posPair = precedence.Position(node->pair);
         if (node->isDelivery && posPair >= s && posPair <= e)  // violating precedence
           break;
 
@@ -100,6 +99,8 @@ PDPMoveEvaluation PDPOroptMove::Evaluate(PDPSolution* solution, PDPNode* pickupN
     }
   }
 
+  Work::Add(work);
+
   if (eval.cost < -0.01) {
     eval.cost += solution->cost;
   } else {
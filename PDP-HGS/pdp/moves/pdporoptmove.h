@@ -76,7 +76,6 @@ class PDPOroptMove : public PDPMove {
 
     double* accumulatedLoad;
     int* positions;
-    bool* visited;
     PDPBlockRelocateMoveState state;
 };
 
@@ -3,6 +3,7 @@
 #include "pdp/pdproute.h"
 #include "utils/application.h"
 #include "utils/random.h"
+#include "utils/work.h"
 
 using namespace std;
 using namespace ga;
@@ -120,6 +121,8 @@ PDPMoveEvaluation PDPRelocateMove::Evaluate(PDPSolution* solution, PDPNode* pick
     }
   }
 
+  Work::Add(inseringWork.size() + 2 * routeSZ);
+
   if (selectedMoveCost < DBL_MAX) {
     state.originPickup = positionPickup;
     state.originDelivery = positionDelivery;
@@ -3,12 +3,16 @@
 #include <stdio.h>
 
 #include <algorithm>
+#include <atomic>
 #include <iostream>
+#include <stdexcept>
 
 #include "pdp/moves/pdpmove.h"
 #include "pdp/pdproute.h"
 #include "utils/application.h"
 #include "utils/random.h"
+#include "utils/threadpool.h"
+#include "utils/trace.h"
 
 namespace pdp {
 
@@ -23,26 +27,50 @@ Educate::Educate() {
   }
 
   educateTotalCount = educateCount = 0;
+  scheduler = nullptr;
+  fullPass = false;
 }
 
 Educate::~Educate() {
+  delete scheduler;
   for (unsigned int i = 0; i < size(); i++) {
     delete at(i);
   }
 }
 
 bool Educate::Run(PDPSolution* solution) {
+  return Run(solution, pickupNodes);
+}
+
+bool Educate::Run(PDPSolution* solution, std::vector<PDPNode*>& pickups) {
+  Trace::Span span("Educate");
   bool improved;
   bool useSlowNeighborhoods = Random::RandomReal() < Application::slow_nb_percentage;
 
+  // the scheduler decides which slow neighborhoods are worth their time
+  if (Application::adaptive_nb) {
+    if (scheduler == nullptr) scheduler = new Scheduler(*this, Application::seed);
+    useSlowNeighborhoods = true;
+  }
+
+  fullPass = false;
   do {
-    improved = FastNeighborhoods(solution);
+    improved = FastNeighborhoods(solution, pickups);
 
     if (Application::Timeout()) break;
 
     if (useSlowNeighborhoods) {
       improved = improved | SlowNeighborhoods(solution);
     }
+
+    // a solution is a local optimum only once a pass with every neighborhood fails
+    if (scheduler != nullptr) {
+      if (improved) {
+        fullPass = false;
+      } else if (!fullPass) {
+        improved = fullPass = true;
+      }
+    }
   } while (improved);
   solution->Recompute();
 
@@ -51,27 +79,85 @@ bool Educate::Run(PDPSolution* solution) {
   return true;
 }
 
+void Educate::SetLocalOptimum(const PDPSolution* solution) {
+  for (pdp::moves::PDPMove* move : *this) {
+    move->SetLocalOptimum(solution);
+  }
+}
+
 //! Perform Fast Neighborhood Local Search
 bool Educate::FastNeighborhoods(PDPSolution* solution) {
+  return FastNeighborhoods(solution, pickupNodes);
+}
+
+bool Educate::FastNeighborhoods(PDPSolution* solution, std::vector<PDPNode*>& pickups) {
   bool improved = false;
-  random_shuffle(pickupNodes.begin(), pickupNodes.end());
+  random_shuffle(pickups.begin(), pickups.end());
+  BeginPass(Scheduler::FAST);
 
-  for (PDPNode* pickupNode : pickupNodes) {
+  for (PDPNode* pickupNode : pickups) {
     // Best route insert for this P-D pair.
     pdp::moves::PDPMoveEvaluation bestMove = EvaluateBestNeighborhood(solution, pickupNode);
+    double gain = solution->cost - bestMove.cost;
 
     // Apply move
-    improved |= bestMove.Apply(solution, false);
+    if (bestMove.Apply(solution, false)) {
+      Credit(bestMove, gain);
+      improved = true;
+    }
 
     if (Application::Timeout()) break;
   }
+
+  EndPass(Scheduler::FAST);
   return improved;
 }
 
 bool Educate::SlowNeighborhoods(PDPSolution* solution) {
+  Trace::Span span("SlowNeighborhoods");
+  BeginPass(Scheduler::SLOW);
+  if (Moves().empty()) return false;
+
   pdp::moves::PDPMoveEvaluation current;
   current = EvaluateBestNeighborhood(solution);
-  return current.Apply(solution, false);
+  double gain = solution->cost - current.cost;
+
+  bool improved = current.Apply(solution, false);
+  if (improved) Credit(current, gain);
+
+  EndPass(Scheduler::SLOW);
+  return improved;
+}
+
+void Educate::BeginPass(Scheduler::Phase phase) {
+  if (scheduler == nullptr) return;
+
+  if (fullPass) {
+    active = *this;
+  } else {
+    scheduler->Select(phase, active);
+  }
+  activeGain.assign(active.size(), 0);
+  activeTime.resize(active.size());
+  for (size_t i = 0; i < active.size(); i++) {
+    activeTime[i] = active[i]->CpuTime();
+  }
+}
+
+void Educate::Credit(const pdp::moves::PDPMoveEvaluation& move, double gain) {
+  if (scheduler == nullptr) return;
+
+  for (size_t i = 0; i < active.size(); i++) {
+    if (active[i] == move.neighborhood) activeGain[i] += gain;
+  }
+}
+
+void Educate::EndPass(Scheduler::Phase phase) {
+  if (scheduler == nullptr) return;
+
+  for (size_t i = 0; i < active.size(); i++) {
+    scheduler->Update(phase, active[i], activeGain[i], active[i]->CpuTime() - activeTime[i]);
+  }
 }
 
 pdp::moves::PDPMoveEvaluation Educate::EvaluateBestNeighborhood(PDPSolution* solution) {
@@ -79,11 +165,29 @@ pdp::moves::PDPMoveEvaluation Educate::EvaluateBestNeighborhood(PDPSolution* sol
   best.cost = solution->cost;
   best.neighborhood = nullptr;
 
-  Random::shuffle(this->begin(), this->end());
-  for (Educate::iterator it = begin(); it != end(); it++) {
-    clock_t startTime = clock();
+  // the scheduler already sorted its selection by rate
+  std::vector<pdp::moves::PDPMove*>& moves = Moves();
+  if (scheduler == nullptr) Random::shuffle(moves.begin(), moves.end());
+
+  ThreadPool* pool = Application::parallel_nb ? ThreadPool::Shared() : nullptr;
+  if (pool != nullptr && EvaluateConcurrently(solution, moves, pool)) {
+    // same choice as the sequential loop below, the evaluations being independent
+    for (size_t i = 0; i < moves.size(); i++) {
+      if (evaluations[i].cost < best.cost) {
+        best = evaluations[i];
+        if (Application::firstimprovement) break;
+      }
+    }
+    return best;
+  }
+
+  for (Educate::iterator it = moves.begin(); it != moves.end(); it++) {
+    Trace::Span span(Trace::enabled ? Trace::Intern((*it)->name()) : nullptr);
+    int64_t startTime = Profile::Now();
+    int64_t profileStart = Profile::Start();
     pdp::moves::PDPMoveEvaluation current = (*it)->Evaluate(solution);
-    (*it)->AddCpuTime(1000 * static_cast<double>(clock() - startTime) / CLOCKS_PER_SEC);
+    (*it)->evaluateProfile[Scheduler::SLOW].Stop(profileStart, solution->cost - current.cost);
+    (*it)->AddCpuTime((Profile::Now() - startTime) / 1e6);
 
     if (current.cost < best.cost) {
       best = current;
@@ -94,16 +198,38 @@ pdp::moves::PDPMoveEvaluation Educate::EvaluateBestNeighborhood(PDPSolution* sol
   return best;
 }
 
+bool Educate::EvaluateConcurrently(PDPSolution* solution, std::vector<pdp::moves::PDPMove*>& moves,
+                                   ThreadPool* pool) {
+  evaluations.assign(moves.size(), pdp::moves::PDPMoveEvaluation());
+
+  // each neighborhood has its own scratch, and the threads take the next one as they finish
+  std::atomic<int> next(0);
+  return pool->Run([&](int) {
+    for (int i = next++; i < (int)moves.size(); i = next++) {
+      Trace::Span span(Trace::enabled ? Trace::Intern(moves[i]->name()) : nullptr);
+      double startTime = ThreadPool::ThreadCpuTime();
+      int64_t profileStart = Profile::Start();
+      evaluations[i] = moves[i]->Evaluate(solution);
+      moves[i]->evaluateProfile[Scheduler::SLOW].Stop(profileStart, solution->cost - evaluations[i].cost);
+      moves[i]->AddCpuTime(ThreadPool::ThreadCpuTime() - startTime);
+    }
+  });
+}
+
 pdp::moves::PDPMoveEvaluation Educate::EvaluateBestNeighborhood(PDPSolution* solution, PDPNode* pickupNode) {
   pdp::moves::PDPMoveEvaluation best;
   best.cost = solution->cost;
   best.neighborhood = nullptr;
 
-  Random::shuffle(this->begin(), this->end());
-  for (Educate::iterator it = begin(); it != end(); it++) {
-    clock_t startTime = clock();
+  std::vector<pdp::moves::PDPMove*>& moves = Moves();
+  if (scheduler == nullptr) Random::shuffle(moves.begin(), moves.end());
+
+  for (Educate::iterator it = moves.begin(); it != moves.end(); it++) {
+    int64_t startTime = Profile::Now();
+    int64_t profileStart = Profile::Start();
     pdp::moves::PDPMoveEvaluation current = (*it)->Evaluate(solution, pickupNode);
-    (*it)->AddCpuTime(1000 * static_cast<double>(clock() - startTime) / CLOCKS_PER_SEC);
+    (*it)->evaluateProfile[Scheduler::FAST].Stop(profileStart, solution->cost - current.cost);
+    (*it)->AddCpuTime((Profile::Now() - startTime) / 1e6);
     if (current.cost < best.cost) {
       best = current;
       if (Application::firstimprovement) break;
@@ -124,6 +250,69 @@ size_t Educate::ResetCounts() {
   return ret;
 }
 
+std::vector<size_t> Educate::State() const {
+  // the neighborhoods are shuffled in place too, their order is saved by name
+  std::vector<std::string> names;
+  for (const pdp::moves::PDPMove* move : *this) {
+    names.push_back(move->name());
+  }
+  std::sort(names.begin(), names.end());
+
+  std::vector<size_t> state;
+  state.push_back(educateTotalCount);
+  state.push_back(educateCount);
+  for (const pdp::moves::PDPMove* move : *this) {
+    state.push_back(std::find(names.begin(), names.end(), move->name()) - names.begin());
+    state.push_back(move->TotalCount());
+    state.push_back(move->Count());
+  }
+
+  // the fast neighborhoods shuffle the previous order of the pickup nodes
+  for (const PDPNode* node : pickupNodes) {
+    state.push_back(node->idx);
+  }
+  return state;
+}
+
+void Educate::Restore(const std::vector<size_t>& state) {
+  if (state.size() != 2 + 3 * size() + pickupNodes.size())
+    throw std::runtime_error("Checkpoint of other neighborhoods or instance");
+
+  std::vector<pdp::moves::PDPMove*> moves = *this;
+  std::sort(moves.begin(), moves.end(), [](const pdp::moves::PDPMove* a, const pdp::moves::PDPMove* b) {
+    return a->name() < b->name();
+  });
+
+  PDPNode** nodes = (PDPNode**)Application::instance->Data();
+  size_t k = 0;
+  educateTotalCount = state[k++];
+  educateCount = state[k++];
+  for (pdp::moves::PDPMove*& move : *this) {
+    if (state[k] >= moves.size()) throw std::runtime_error("Checkpoint of other neighborhoods or instance");
+    move = moves[state[k]];
+    move->RestoreCount(state[k + 1], state[k + 2]);
+    k += 3;
+  }
+
+  for (PDPNode*& node : pickupNodes) {
+    if (state[k] >= Application::instance->Size() || !nodes[state[k]]->isPickup)
+      throw std::runtime_error("Checkpoint of other neighborhoods or instance");
+    node = nodes[state[k++]];
+  }
+}
+
+std::string Educate::SchedulerState() const {
+  return scheduler ? scheduler->State() : std::string();
+}
+
+void Educate::RestoreScheduler(const std::string& state) {
+  if (state.empty()) return;
+  if (!Application::adaptive_nb) throw std::runtime_error("Checkpoint of a run with --adaptive-nb");
+
+  if (scheduler == nullptr) scheduler = new Scheduler(*this, Application::seed);
+  scheduler->Restore(state);
+}
+
 struct less_than_key_move {
     inline bool operator()(const pdp::moves::PDPMove* m1, const pdp::moves::PDPMove* m2) {
       return m1->name() < m2->name();
@@ -161,11 +350,28 @@ std::string Educate::TotalMovesLog(bool percent) const {
   if (!percent) {
     sprintf(buff, ",\t  \"educate\": %zu", educateTotalCount);
     s += buff;
+
+    if (scheduler != nullptr) s += ",\t  \"scheduler\": " + scheduler->Log();
   }
 
   return s;
 }
 
+std::string Educate::ProfileLog() const {
+  std::vector<pdp::moves::PDPMove*> tmpmoves = *this;
+  std::sort(tmpmoves.begin(), tmpmoves.end(), less_than_key_move());
+
+  std::string s = "{";
+  for (size_t i = 0; i < tmpmoves.size(); i++) {
+    pdp::moves::PDPMove* move = tmpmoves[i];
+    s += (i ? ",\t      \"" : "\t      \"") + move->name() + "\": {";
+    s += "\t        \"fast\": " + move->evaluateProfile[Scheduler::FAST].Json() + ",";
+    s += "\t        \"slow\": " + move->evaluateProfile[Scheduler::SLOW].Json() + ",";
+    s += "\t        \"apply\": " + move->applyProfile.Json() + "\t      }";
+  }
+  return s + "\t    }";
+}
+
 std::string Educate::MovesLog(bool percent) const {
   const char* extra = 0;
   std::string s;
@@ -25,9 +25,11 @@ SOFTWARE.*/
 
 #include "pdp/moves/pdp4optmove.h"
 #include "pdp/moves/pdpmoveevaluation.h"
+#include "pdp/pdpscheduler.h"
 #include "pdp/pdpsolution.h"
 
 class PDPNode;
+class ThreadPool;
 
 namespace pdp {
 
@@ -42,20 +44,54 @@ class Educate : public std::vector<pdp::moves::PDPMove*> {
     //! Perform  Fast-Slow-Fast Local Search
     bool Run(PDPSolution* solution);
 
+    //! Perform Fast-Slow-Fast Local Search, the fast neighborhoods only moving some pickup nodes.
+    //! \param pickups: pickup nodes to move (shuffled), e.g. those around the changes of a local optimum.
+    bool Run(PDPSolution* solution, std::vector<PDPNode*>& pickups);
+
+    //! Take the current route of a solution as a local optimum of every neighborhood, the slow
+    //! neighborhoods then only considering the changes made from now on.
+    void SetLocalOptimum(const PDPSolution* solution);
+
     //! Perform Fast Neighborhood Local Search
     bool FastNeighborhoods(PDPSolution* solution);
 
+    //! Perform Fast Neighborhood Local Search on some pickup nodes.
+    //! \param pickups: pickup nodes to move (shuffled).
+    bool FastNeighborhoods(PDPSolution* solution, std::vector<PDPNode*>& pickups);
+
     //! Perform Slow Neighborhood Local Search
     bool SlowNeighborhoods(PDPSolution* solution);
 
     size_t Count() const {
       return educateCount;
     }
+    size_t TotalCount() const {
+      return educateTotalCount;
+    }
     size_t ResetCounts();
 
+    //! Get the move counts and the neighborhood and pickup node orders, which change the next educations
+    //! (checkpoint).
+    std::vector<size_t> State() const;
+
+    //! Restore a state got from State.
+    //! \throw std::runtime_error: if the state belongs to other neighborhoods or instance.
+    void Restore(const std::vector<size_t>& state);
+
+    //! Get the state of the adaptive scheduler, empty if it is not used (checkpoint).
+    std::string SchedulerState() const;
+
+    //! Restore a state got from SchedulerState, the scheduler being created if needed.
+    //! \throw std::runtime_error: if the state belongs to other neighborhoods, or to a run with --adaptive-nb
+    //! while this one runs without.
+    void RestoreScheduler(const std::string& state);
+
     std::string MovesLog(bool percent = false) const;
     std::string TotalMovesLog(bool percent = false) const;
 
+    //! Get the profile of every neighborhood as a JSON object (--profile).
+    std::string ProfileLog() const;
+
   protected:
     //! Evaluate best neighborhood.
     //! \param solution: current Solution representation.
@@ -69,10 +105,47 @@ class Educate : public std::vector<pdp::moves::PDPMove*> {
     //! found in route.
     pdp::moves::PDPMoveEvaluation EvaluateBestNeighborhood(PDPSolution* solution);
 
+    //! Evaluate every neighborhood concurrently, storing the results in evaluations.
+    //! \param solution: current Solution representation (read only).
+    //! \param moves: neighborhoods to evaluate.
+    //! \param pool: threads evaluating the neighborhoods.
+    //! \return bool: false if the pool is busy (nothing is evaluated).
+    bool EvaluateConcurrently(PDPSolution* solution, std::vector<pdp::moves::PDPMove*>& moves,
+                              ThreadPool* pool);
+
+    //! Neighborhoods evaluated in the current pass: all of them, or those selected by the scheduler.
+    std::vector<pdp::moves::PDPMove*>& Moves() {
+      return scheduler ? active : *this;
+    }
+
+    //! Select the neighborhoods of a local search pass (adaptive scheduling only, every neighborhood
+    //! in a full pass).
+    void BeginPass(Scheduler::Phase phase);
+
+    //! Credit the cost decrease of an applied move to its neighborhood (adaptive scheduling only).
+    void Credit(const pdp::moves::PDPMoveEvaluation& move, double gain);
+
+    //! Report the gain and time of every neighborhood of the pass to the scheduler.
+    void EndPass(Scheduler::Phase phase);
+
   protected:
     //! pickup nodes to evaluate.
     std::vector<PDPNode*> pickupNodes;  // O(n/2) space
 
+    //! evaluations of the neighborhoods (when evaluated concurrently).
+    std::vector<pdp::moves::PDPMoveEvaluation> evaluations;
+
+    //! adaptive neighborhood scheduler (nullptr unless --adaptive-nb).
+    Scheduler* scheduler;
+
+    //! neighborhoods of the current pass, with their gain and CPU time when the pass began.
+    std::vector<pdp::moves::PDPMove*> active;
+    std::vector<double> activeGain;
+    std::vector<double> activeTime;
+
+    //! the current pass uses every neighborhood, to confirm a local optimum.
+    bool fullPass;
+
     size_t educateCount;
     size_t educateTotalCount;
 };
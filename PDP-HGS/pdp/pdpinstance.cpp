@@ -4,6 +4,7 @@
 
 #include <algorithm>
 #include <iostream>
+#include <stdexcept>
 
 #include "instancereader.h"
 #include "moves/pdp2koptmove.h"
@@ -14,11 +15,20 @@
 #include "moves/pdprelocatemove.h"
 #include "pdproute.h"
 #include "utils/application.h"
+#include "utils/checkpoint.h"
 #include "utils/random.h"
+#include "utils/work.h"
 
 using namespace std;
 
 namespace pdp {
+bool PDPInstance::Closer(int i, int a, int b) const {
+  double d1 = (a != i) ? distances[i][a] : DBL_MAX;
+  double d2 = (b != i) ? distances[i][b] : DBL_MAX;
+
+  return d1 < d2;
+}
+
 void PDPInstance::PrecomputeClosest(int /*closeindividuals*/) {
   closest.resize(numberOfNodes);
 
@@ -35,10 +45,7 @@ void PDPInstance::PrecomputeClosest(int /*closeindividuals*/) {
   for (size_t i = 0; i < numberOfNodes; i++) {
     // sort by distance ASC
     std::sort(nodeids.begin(), nodeids.end(), [this, i](const int customerA, const int customerB) {
-      double d1 = (customerA != i) ? distances[i][customerA] : DBL_MAX;
-      double d2 = (customerB != i) ? distances[i][customerB] : DBL_MAX;
-
-      return d1 < d2;
+      return Closer(i, customerA, customerB);
     });
 
     closest[i] = nodeids;
@@ -46,6 +53,15 @@ void PDPInstance::PrecomputeClosest(int /*closeindividuals*/) {
   }
 }
 
+//! Rounded Euclidean distance between two nodes.
+inline double Distance(const PDPNode* a, const PDPNode* b) {
+  double dx = a->x - b->x;
+  double dy = a->y - b->y;
+
+  double dist = (double)sqrt(dx * dx + dy * dy);
+  return (int)(dist + 0.5);
+}
+
 void PDPInstance::PrecomputeDistanceMatrix() {
   if (!distances) {
     distances = new double*[numberOfNodes];
@@ -54,19 +70,139 @@ void PDPInstance::PrecomputeDistanceMatrix() {
       distances[i] = new double[numberOfNodes];
     }
 
-    double dx;
-    double dy;
     for (size_t i = 0; i < numberOfNodes; i++) {
       distances[i][i] = 0.0;
       for (size_t j = i + 1; j < numberOfNodes; j++) {
-        dx = nodes[i]->x - nodes[j]->x;
-        dy = nodes[i]->y - nodes[j]->y;
+        distances[i][j] = distances[j][i] = Distance(nodes[i], nodes[j]);
+      }
+    }
+  }
+}
+
+void PDPInstance::SetDistances(const std::vector<std::vector<double> >& matrix) {
+  euclidean = false;
+  if (!distances) {
+    distances = new double*[numberOfNodes];
+    for (size_t i = 0; i < numberOfNodes; i++) distances[i] = new double[numberOfNodes];
+  }
+
+  for (size_t i = 0; i < numberOfNodes; i++) {
+    for (size_t j = 0; j < numberOfNodes; j++) distances[i][j] = (i == j) ? 0.0 : matrix[i][j];
+  }
+}
+
+PDPInstance* PDPInstance::Update(const PDPInstance& base, const vector<vector<double> >& added,
+                                 const vector<int>& removed, const vector<vector<double> >& addedDistances,
+                                 const vector<vector<double> >& addedDistancesTo, vector<int>& renumber) {
+  size_t n = base.numberOfNodes;
+  vector<bool> dropped(n, false);
+  for (int node : removed) {
+    if (node < 1 || node >= (int)n) throw runtime_error("Unknown node " + to_string(node) + ".");
+    dropped[node] = dropped[base.nodes[node]->pair] = true;
+  }
+  for (const vector<double>& request : added) {
+    if (request.size() != 4)
+      throw runtime_error("An added request is [pickup x, pickup y, delivery x, delivery y].");
+  }
+  if (!added.empty() && !base.euclidean && (addedDistances.empty() || addedDistancesTo.empty()))
+    throw runtime_error("The requests added to a distance matrix instance need their distances.");
+  if (addedDistances.empty() != addedDistancesTo.empty())
+    throw runtime_error("The added distances need both their rows and their columns.");
+
+  // the kept nodes keep their order, the added pickups and deliveries follow them
+  vector<int> original;
+  renumber.assign(n, -1);
+  for (size_t i = 0; i < n; i++) {
+    if (dropped[i]) continue;
+    renumber[i] = original.size();
+    original.push_back(i);
+  }
+  size_t kept = original.size();
+  size_t m = kept + 2 * added.size();
+  if (m < 3) throw runtime_error("The instance needs a depot and pickup-delivery pairs.");
+  if (!addedDistances.empty()) {
+    if (addedDistances.size() != 2 * added.size() || addedDistancesTo.size() != 2 * added.size())
+      throw runtime_error("The added distances are not a row and a column per added node.");
+    for (size_t k = 0; k < addedDistances.size(); k++) {
+      if (addedDistances[k].size() != m || addedDistancesTo[k].size() != m)
+        throw runtime_error("The added distances are not a row and a column per added node.");
+    }
+  }
+
+  NodeList nodes;
+  for (int i : original) {
+    PDPNode* node = new PDPNode(*base.nodes[i]);
+    node->idx = renumber[i];
+    node->pair = i > 0 ? renumber[node->pair] : 0;
+    nodes.push_back(node);
+  }
+  for (const vector<double>& request : added) {
+    for (int k = 0; k < 2; k++) {
+      PDPNode* node = new PDPNode();
+      node->idx = nodes.size();
+      node->x = request[2 * k];
+      node->y = request[2 * k + 1];
+      node->pair = k == 0 ? node->idx + 1 : node->idx - 1;
+      node->isPickup = k == 0;
+      node->isDelivery = k == 1;
+      nodes.push_back(node);
+    }
+  }
 
-        double dist = (double)sqrt(dx * dx + dy * dy);
-        distances[i][j] = distances[j][i] = (int)(dist + 0.5);
+  PDPInstance* instance = new PDPInstance(base.nclosest, nodes, base.comment);
+  instance->euclidean = base.euclidean && addedDistances.empty();
+
+  // the distances of the kept nodes are copied, only the added nodes get new ones
+  double** distances = instance->distances = new double*[m];
+  for (size_t i = 0; i < m; i++) {
+    distances[i] = new double[m];
+    for (size_t j = 0; j < m; j++) {
+      if (i < kept && j < kept) {
+        distances[i][j] = base.distances[original[i]][original[j]];
+      } else if (i == j) {
+        distances[i][j] = 0.0;
+      } else if (!addedDistances.empty()) {
+        // the matrix may be asymmetric: from an added node its row, to an added node its column
+        distances[i][j] = (i >= kept) ? addedDistances[i - kept][j] : addedDistancesTo[j - kept][i];
+      } else {
+        distances[i][j] = Distance(nodes[i], nodes[j]);
       }
     }
   }
+
+  // the closest lists of the kept nodes only get the added nodes inserted
+  instance->closest.resize(m);
+  instance->fartherClose.resize(m);
+  for (size_t i = 0; i < m; i++) {
+    vector<int>& closest = instance->closest[i];
+    auto closer = [instance, i](const int customerA, const int customerB) {
+      return instance->Closer(i, customerA, customerB);
+    };
+
+    if (i < kept) {
+      for (int node : base.closest[original[i]]) {
+        if (renumber[node] >= 0) closest.push_back(renumber[node]);
+      }
+      for (size_t j = kept; j < m; j++) {
+        closest.insert(std::upper_bound(closest.begin(), closest.end(), (int)j, closer), j);
+      }
+    } else {
+      for (size_t j = 0; j < m; j++) closest.push_back(j);
+      std::sort(closest.begin(), closest.end(), closer);
+    }
+    instance->fartherClose[i] = distances[i][closest[std::min((size_t)instance->nclosest, m - 1)]];
+  }
+
+  return instance;
+}
+
+vector<int> PDPInstance::Renumber(const vector<int>& visits, const vector<int>& renumber) {
+  vector<int> renumbered;
+  for (int visit : visits) {
+    if (visit >= 0 && visit < (int)renumber.size() && renumber[visit] >= 0)
+      renumbered.push_back(renumber[visit]);
+  }
+  return renumbered;
 }
 
 PDPInstance* PDPInstance::fromFilePath(const string instanceFilePath) {
@@ -81,12 +217,48 @@ PDPInstance* PDPInstance::fromFilePath(const string instanceFilePath) {
   return instance;
 }
 
+PDPInstance* PDPInstance::fromData(Checkpoint::Data& data) {
+  size_t n = data.Get<uint64_t>();
+  int nclosest = data.Get<int>();
+  string comment = data.GetString();
+
+  NodeList nodes;
+  for (size_t i = 0; i < n; i++) nodes.push_back(new PDPNode(data.Get<PDPNode>()));
+  PDPInstance* instance = new PDPInstance(nclosest, nodes, comment);
+  instance->euclidean = data.Get<bool>();
+
+  instance->distances = new double*[n];
+  for (size_t i = 0; i < n; i++) {
+    instance->distances[i] = new double[n];
+    vector<double> row = data.GetVector<double>();
+    if (row.size() != n) throw runtime_error("Truncated instance");
+    std::copy(row.begin(), row.end(), instance->distances[i]);
+  }
+  instance->closest.resize(n);
+  for (size_t i = 0; i < n; i++) instance->closest[i] = data.GetVector<int>();
+  instance->fartherClose = data.GetVector<double>();
+  return instance;
+}
+
+void PDPInstance::Save(Checkpoint::Data& data) const {
+  data.Put<uint64_t>(numberOfNodes);
+  data.Put<int>(nclosest);
+  data.PutString(comment);
+  for (const PDPNode* node : nodes) data.Put<PDPNode>(*node);
+  data.Put<bool>(euclidean);
+  for (size_t i = 0; i < numberOfNodes; i++)
+    data.PutVector(vector<double>(distances[i], distances[i] + numberOfNodes));
+  for (const vector<int>& row : closest) data.PutVector(row);
+  data.PutVector(fartherClose);
+}
+
 PDPInstance::PDPInstance(int numberOfCloseIndividuals, const NodeList& nodes, const std::string comment)
     : vehicles(1),
       numberOfNodes(nodes.size()),
       nclosest(numberOfCloseIndividuals),
       comment(comment),
       nodes(nodes) {
+  euclidean = true;
   _visited = nullptr;
   _sucessor = nullptr;
 
@@ -119,10 +291,14 @@ PDPInstance::~PDPInstance() {
 }
 
 void PDPInstance::Precompute() {
-  PrecomputeDistanceMatrix();
-  PrecomputeClosest(nclosest);
+  PrecomputeData();
 
-  if (pEducate) delete pEducate;
+  // an instance solved again (e.g. by the library) gets the neighborhoods of its new options
+  delete pEducate;
+  delete p4optMove;
+  delete pRelocateMove;
+  delete[] _visited;
+  delete[] _sucessor;
 
   pEducate = new pdp::Educate();
   p4optMove = new pdp::moves::PDP4optMove();
@@ -145,6 +321,25 @@ void PDPInstance::Precompute() {
   _sucessor = new int[Application::instance->Size()];
 }
 
+void PDPInstance::PrecomputeData() {
+  PrecomputeDistanceMatrix();
+  if (closest.empty()) PrecomputeClosest(nclosest);
+}
+
+bool PDPInstance::Precomputed() const {
+  return pEducate != nullptr;
+}
+
+uint64_t PDPInstance::Hash() const {
+  uint64_t hash = Checkpoint::Data::Hash(&numberOfNodes, sizeof(numberOfNodes));
+  for (size_t i = 0; i < numberOfNodes; i++) {
+    int request[2] = {nodes[i]->pair, nodes[i]->isPickup};
+    hash = Checkpoint::Data::Hash(request, sizeof(request), hash);
+    hash = Checkpoint::Data::Hash(distances[i], numberOfNodes * sizeof(double), hash);
+  }
+  return hash;
+}
+
 int PDPInstance::CreateRandomSolution(PDPSolution* solution) const {
   PDPNode** nodes = static_cast<PDPNode**>(Application::instance->Data());
 
@@ -180,6 +375,72 @@ ga::Solution* PDPInstance::CreateRandomSolution() const {
   return s;
 }
 
+ga::Solution* PDPInstance::CreateSolution(const std::vector<int>& visits) {
+  return CreateSolution(visits, nullptr);
+}
+
+ga::Solution* PDPInstance::CreateUpdatedSolution(const std::vector<int>& visits) {
+  vector<PDPNode*> around;
+  PDPSolution* solution = CreateSolution(visits, &around);
+  pEducate->Run(solution, around);
+  solution->Recompute();
+  Sort(solution);
+  return solution;
+}
+
+PDPSolution* PDPInstance::CreateSolution(const std::vector<int>& visits, std::vector<PDPNode*>* around) {
+  PDPSolution* solution = (PDPSolution*)CreateEmptySolution();
+  PDPNode** nodes = static_cast<PDPNode**>(Application::instance->Data());
+
+  vector<int> seen(numberOfNodes, 0);
+  for (int v : visits) {
+    if (v > 0 && v < (int)numberOfNodes) seen[v]++;
+  }
+
+  // keep the customers visited once along with their pair
+  solution->route.clear();
+  solution->route.push_back(0);
+  for (int v : visits) {
+    if (v > 0 && v < (int)numberOfNodes && seen[v] == 1 && seen[nodes[v]->pair] == 1)
+      solution->route.push_back(v);
+  }
+  solution->route.push_back(0);
+  solution->ComputePositions();
+  solution->Recompute();
+
+  // the insertions below are the route changes seen by the slow neighborhoods
+  if (around) pEducate->SetLocalOptimum(solution);
+
+  vector<PDPNode*> inserted;
+  for (size_t i = 1; i < numberOfNodes; i++) {
+    if (nodes[i]->isPickup && (seen[i] != 1 || seen[nodes[i]->pair] != 1)) {
+      pdp::moves::PDPMoveEvaluation evaluation = pRelocateMove->Evaluate(solution, nodes[i]);
+      evaluation.Apply(solution, true);
+      inserted.push_back(nodes[i]);
+    }
+  }
+
+  Repair(solution);
+  if (!around) return solution;
+
+  // the inserted pairs and the pairs of their neighbours in the route
+  const PDPRoute& route = solution->route;
+  vector<bool> taken(numberOfNodes, false);
+  for (PDPNode* pickup : inserted) {
+    for (int node : {pickup->idx, pickup->pair}) {
+      int p = solution->FindPosition(node);
+      for (int q = p - 1; q <= p + 1; q++) {
+        if (q < 1 || q >= (int)route.size() - 1) continue;
+        PDPNode* next = nodes[route[q]];
+        if (next->isDelivery) next = nodes[next->pair];
+        if (!taken[next->idx]) around->push_back(next);
+        taken[next->idx] = true;
+      }
+    }
+  }
+  return solution;
+}
+
 void PDPInstance::Educate(ga::Solution* _s) {
   PDPSolution* s = (PDPSolution*)_s;
   pEducate->Run(s);
@@ -231,10 +492,34 @@ void PDPInstance::Mutate(ga::Solution* _solution) {
   moveA.Apply(solution, true);
 }
 
+std::vector<size_t> PDPInstance::LSState() const {
+  return pEducate->State();
+}
+
+void PDPInstance::RestoreLSState(const std::vector<size_t>& state) {
+  pEducate->Restore(state);
+}
+
+std::string PDPInstance::SchedulerState() const {
+  return pEducate->SchedulerState();
+}
+
+void PDPInstance::RestoreSchedulerState(const std::string& state) {
+  pEducate->RestoreScheduler(state);
+}
+
+size_t PDPInstance::Educations() const {
+  return pEducate->TotalCount();
+}
+
 std::string PDPInstance::LSCompleteLog() {
   return pEducate->TotalMovesLog();
 }
 
+std::string PDPInstance::ProfileLog() {
+  return pEducate->ProfileLog();
+}
+
 std::string PDPInstance::LSLog() {
   return pEducate->MovesLog();
 }
@@ -295,6 +580,7 @@ void PDPInstance::Crossover(ga::Solution* _child, const ga::Solution* _p1, const
       k++;
     }
   }
+  Work::Add(r1.size());
 
   child->Recompute();
 }
@@ -344,6 +630,8 @@ double PDPInstance::SolutionDistance(const ga::Solution* _a, const ga::Solution*
     }
   }
 
+  Work::Add(a->route.size() + b->route.size());
+
   size_t lenunion = 2 * (a->route.size() - 1) - lenintersection;
   return static_cast<double>(lenunion - lenintersection) / static_cast<double>(lenunion);
 }
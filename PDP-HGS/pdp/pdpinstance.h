@@ -30,6 +30,7 @@ SOFTWARE.*/
 #include "hgsadc/problem.h"
 #include "pdp/moves/pdprelocatemove.h"
 #include "pdp/pdpeducate.h"
+#include "utils/checkpoint.h"
 
 namespace pdp {
 
@@ -48,12 +49,52 @@ class PDPInstance : public ga::Problem {
     //! \param instanceFilePath: Path for instance file instance
     static PDPInstance* fromFilePath(const std::string instanceFilePath);
 
+    //! Create an instance saved by Save, with its distances and closest customers: only the
+    //! neighborhoods are left to Precompute.
+    static PDPInstance* fromData(Checkpoint::Data& data);
+
+    //! Create an instance from another one with requests added and removed (re-planning). The distance
+    //! matrix and the closest customers of the kept nodes are patched instead of being recomputed.
+    //! \param base: precomputed instance.
+    //! \param added: added requests, as [pickup x, pickup y, delivery x, delivery y] with rounded
+    //! Euclidean distances. Their pickup and delivery follow the kept nodes, in the given order.
+    //! \param removed: a node (pickup or delivery) of each removed request.
+    //! \param addedDistances: distances from each added node to every node of the new instance (empty for
+    //! the rounded Euclidean distances, required if the base is not euclidean).
+    //! \param addedDistancesTo: distances from every node of the new instance to each added node, given
+    //! with addedDistances (the distances between two added nodes are taken from addedDistances).
+    //! \param renumber: filled with the index of each base node in the new instance (-1 if removed).
+    //! \throw std::runtime_error: if a removed node is unknown, a distance is missing or no request is left.
+    static PDPInstance* Update(const PDPInstance& base, const std::vector<std::vector<double> >& added,
+                               const std::vector<int>& removed,
+                               const std::vector<std::vector<double> >& addedDistances,
+                               const std::vector<std::vector<double> >& addedDistancesTo,
+                               std::vector<int>& renumber);
+
+    //! Map the visits of a base instance to an updated one, dropping the removed nodes.
+    //! \param renumber: index of each base node in the updated instance (see Update).
+    static std::vector<int> Renumber(const std::vector<int>& visits, const std::vector<int>& renumber);
+
     //! Destructor
     virtual ~PDPInstance();
 
+    //! Use a given distance matrix instead of the rounded Euclidean distances of the nodes.
+    //! \param matrix: distances between the nodes (the diagonal is ignored).
+    void SetDistances(const std::vector<std::vector<double> >& matrix);
+
     //! Precompute post-load informations
     virtual void Precompute();
 
+    //! Precompute the distance matrix and the closest customers only (the part of Precompute kept by Save).
+    void PrecomputeData();
+
+    //! Save the nodes, the distances and the closest customers of an instance (see PrecomputeData).
+    void Save(Checkpoint::Data& data) const;
+
+    virtual bool Precomputed() const;
+
+    virtual uint64_t Hash() const;
+
     //! Perform local search
     //! \param solution: solution representation to be changed by local search
     //! \param trace: if true, every local search step will be displayed.
@@ -65,8 +106,28 @@ class PDPInstance : public ga::Problem {
     //! \param s: solution to be filled with a random valid solution
     virtual ga::Solution* CreateRandomSolution() const;
 
+    //! Create a solution from a given visit order: the unknown or repeated customers and the customers
+    //! without their pair are dropped, the missing pairs are inserted at their best position and the
+    //! pairs visiting the delivery first are relocated.
+    //! \param visits: customers in visit order (with or without the depot).
+    virtual ga::Solution* CreateSolution(const std::vector<int>& visits);
+
+    //! Create an educated solution from a local optimum missing some requests: the missing pairs are
+    //! inserted as by CreateSolution, then the fast neighborhoods only move them and the pairs next to
+    //! them, and the slow neighborhoods only consider the route changes since the local optimum.
+    //! \param visits: customers in visit order, a local optimum but for the missing requests.
+    virtual ga::Solution* CreateUpdatedSolution(const std::vector<int>& visits);
+
     void Sort(PDPSolution* solution);
 
+    virtual std::vector<size_t> LSState() const;
+    virtual void RestoreLSState(const std::vector<size_t>& state);
+    virtual std::string SchedulerState() const;
+    virtual void RestoreSchedulerState(const std::string& state);
+
+    //! Number of educations since the local search was created.
+    size_t Educations() const;
+
     virtual size_t Size() const;
 
     virtual void* Data();
@@ -92,6 +153,11 @@ class PDPInstance : public ga::Problem {
     //! \param s: solution to be filled with a random valid solution
     virtual int CreateRandomSolution(PDPSolution* s) const;
 
+    //! Create a solution from a given visit order (see CreateSolution).
+    //! \param around: if not null, the kept route is taken as a local optimum of the local search, and
+    //! around is filled with the pickups of the inserted pairs and of the pairs next to them.
+    PDPSolution* CreateSolution(const std::vector<int>& visits, std::vector<PDPNode*>* around);
+
     //! Precompute distance between customers
     virtual void PrecomputeDistanceMatrix();
 
@@ -99,6 +165,9 @@ class PDPInstance : public ga::Problem {
     //! \param size: number of closest individuals
     virtual void PrecomputeClosest(int closeindividuals);
 
+    //! Check if customer a is closer than customer b to customer i (the customer i itself last).
+    bool Closer(int i, int a, int b) const;
+
   public:
     int* _sucessor;
 
@@ -114,6 +183,9 @@ class PDPInstance : public ga::Problem {
     //! Instance comment
     const std::string comment;
 
+    //! The distances are the rounded Euclidean distances of the nodes (not a given matrix).
+    bool euclidean;
+
     //! closest individuals maps.
     std::vector<std::vector<int> > closest;
     std::vector<double> fartherClose;
@@ -122,6 +194,7 @@ class PDPInstance : public ga::Problem {
     NodeList nodes;
 
     virtual std::string LSCompleteLog();
+    virtual std::string ProfileLog();
     virtual std::string LSLog();
     virtual void LSLogReset();
 
@@ -0,0 +1,132 @@
+#include "pdpprecedenceindex.h"
+
+#include <algorithm>
+
+#include "pdp/pdpnode.h"
+#include "pdp/pdpsolution.h"
+#include "utils/application.h"
+
+namespace pdp {
+
+PDPPrecedenceIndex::PDPPrecedenceIndex() : route(nullptr), positions(nullptr), version(0), built(0), size(0) {
+}
+
+const PDPPrecedenceIndex& PDPPrecedenceIndex::Get(const PDPSolution* solution) {
+  static thread_local PDPPrecedenceIndex index;
+
+  index.route = &solution->route;
+  index.positions = solution->Positions();
+  index.version = solution->Version();
+  if (index.size != (int)solution->route.size()) index.built = 0;
+
+  return index;
+}
+
+void PDPPrecedenceIndex::Build() const {
+  PDPNode** nodes = static_cast<PDPNode**>(Application::instance->Data());
+  const PDPRoute& route = *this->route;
+
+  built = version;
+  size = (int)route.size();
+
+  int levels = 1;
+  while ((1 << levels) <= size) levels++;
+
+  log2.resize(size + 1);
+  log2[1] = 0;
+  for (int len = 2; len <= size; len++) {
+    log2[len] = log2[len / 2] + 1;
+  }
+
+  innerPair.resize((size_t)levels * size);
+  for (int i = 0; i < size; i++) {
+    const PDPNode& node = *nodes[route[i]];
+    const int pairPos = (node.idx != 0) ? positions[node.pair] : -1;
+    innerPair[i] = (pairPos < i) ? pairPos : -1;
+  }
+
+  for (int level = 1; level < levels; level++) {
+    const int* prev = &innerPair[(level - 1) * size];
+    int* row = &innerPair[level * size];
+    const int half = 1 << (level - 1);
+    for (int i = 0; i + (1 << level) <= size; i++) {
+      row[i] = std::max(prev[i], prev[i + half]);
+    }
+  }
+
+  // node 0 is the empty tree, every pickup adds one path to the previous version
+  tree.clear();
+  tree.reserve((size_t)(levels + 2) * size);
+  tree.push_back(TreeNode{0, 0, -1});
+
+  roots.resize(size + 1);
+  roots[0] = 0;
+  for (int v = 1; v <= size; v++) {
+    const PDPNode& node = *nodes[route[v - 1]];
+    roots[v] = roots[v - 1];
+    if (node.idx != 0 && !node.isDelivery) {
+      roots[v] = Insert(roots[v], 0, size - 1, positions[node.pair], v - 1);
+    }
+  }
+}
+
+int PDPPrecedenceIndex::Insert(int root, int lo, int hi, int index, int value) const {
+  int created = (int)tree.size();
+  tree.push_back(tree[root]);
+  tree[created].value = std::max(tree[created].value, value);
+
+  if (lo < hi) {
+    int mid = (lo + hi) / 2;
+    if (index <= mid) {
+      int child = Insert(tree[root].left, lo, mid, index, value);
+      tree[created].left = child;
+    } else {
+      int child = Insert(tree[root].right, mid + 1, hi, index, value);
+      tree[created].right = child;
+    }
+  }
+
+  return created;
+}
+
+int PDPPrecedenceIndex::Later(int i, int j) const {
+  if (i > j) return -1;
+  if (built != version) Build();
+
+  int best = -1;
+  int stack[64][3];
+  int top = 0;
+
+  stack[top][0] = roots[i];
+  stack[top][1] = 0;
+  stack[top][2] = size - 1;
+  top++;
+
+  while (top) {
+    top--;
+    const int t = stack[top][0];
+    const int lo = stack[top][1];
+    const int hi = stack[top][2];
+
+    if (t == 0 || tree[t].value <= best || hi < i || lo > j) continue;
+
+    if (i <= lo && hi <= j) {
+      best = tree[t].value;
+      continue;
+    }
+
+    const int mid = (lo + hi) / 2;
+    stack[top][0] = tree[t].left;
+    stack[top][1] = lo;
+    stack[top][2] = mid;
+    top++;
+    stack[top][0] = tree[t].right;
+    stack[top][1] = mid + 1;
+    stack[top][2] = hi;
+    top++;
+  }
+
+  return best;
+}
+
+}  // namespace pdp
@@ -0,0 +1,107 @@
+/*MIT License
+ *
+Copyright(c) 2022 Toni Pacheco
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+#ifndef PDPPRECEDENCEINDEX_H
+#define PDPPRECEDENCEINDEX_H
+
+#include <vector>
+
+#include "pdp/pdproute.h"
+
+namespace pdp {
+
+class PDPSolution;
+
+//! Pickup and delivery precedence queries on route index ranges, shared by the local search moves.
+class PDPPrecedenceIndex {
+  public:
+    //! Default constructor.
+    PDPPrecedenceIndex();
+
+    //! Get the index of a solution route. Positions are read from the solution, the range tables
+    //! are built in O(n log n) on the first range query of a solution version and kept per thread,
+    //! so all moves evaluating the same route share them.
+    //! \param solution: solution with up to date positions.
+    //! \return const PDPPrecedenceIndex&: index valid until the next call on this thread.
+    static const PDPPrecedenceIndex& Get(const PDPSolution* solution);
+
+    //! Route index of a customer.
+    int Position(int node) const {
+      return positions[node];
+    }
+
+    //! Route index of every customer (-1 for the depot).
+    const int* Positions() const {
+      return positions;
+    }
+
+    //! O(1) check that no pickup and delivery pair lies entirely in route range [i, j].
+    //! \return bool: true if [i, j] can be reversed (empty ranges included).
+    bool Reversible(int i, int j) const {
+      if (i > j) return true;
+      if (built != version) Build();
+
+      const int level = log2[j - i + 1];
+      const int* row = &innerPair[level * size];
+      return std::max(row[i], row[j - (1 << level) + 1]) < i;
+    }
+
+    //! O(log n) latest pickup index before i of the deliveries in route range [i, j].
+    //! \return int: pickup index, -1 if no delivery of [i, j] has its pickup before i.
+    int Later(int i, int j) const;
+
+  private:
+    //! Build the range tables of the current route.
+    void Build() const;
+
+    //! Persistent max segment tree node.
+    struct TreeNode {
+        int left;
+        int right;
+        int value;
+    };
+
+    int Insert(int tree, int lo, int hi, int index, int value) const;
+
+    //! Route indexed and its customer positions.
+    const PDPRoute* route;
+    const int* positions;
+    //! Solution version of the route (0 for none).
+    size_t version;
+
+    //! Solution version the tables below were built for, and its route size.
+    mutable size_t built;
+    mutable int size;
+
+    //! Sparse table over route indices of "earlier position of the pair" (-1 for none), level by level.
+    mutable std::vector<int> innerPair;
+    //! Floor of log2 of each range length.
+    mutable std::vector<int> log2;
+
+    //! Tree root of every version v, holding at its delivery index each pickup of index < v.
+    mutable std::vector<int> roots;
+    mutable std::vector<TreeNode> tree;
+};
+
+}  // namespace pdp
+
+#endif  // PDPPRECEDENCEINDEX_H
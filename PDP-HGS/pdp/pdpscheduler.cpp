@@ -0,0 +1,118 @@
+#include "pdpscheduler.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+#include "pdp/moves/pdpmove.h"
+
+namespace pdp {
+
+Scheduler::Scheduler(const std::vector<moves::PDPMove*>& moves, unsigned int seed)
+    : moves(moves), generator(seed) {
+  Arm empty = {0, 0, 0};
+  arms[FAST].assign(moves.size(), empty);
+  arms[SLOW].assign(moves.size(), empty);
+}
+
+double Scheduler::Weight(Phase phase, int move) const {
+  const Arm& arm = arms[phase][move];
+  if (arm.pulls == 0) return 1;
+
+  double best = 0;
+  for (const Arm& other : arms[phase]) {
+    if (other.pulls > 0) best = std::max(best, other.gain / std::max(other.time, SCHEDULER_MIN_TIME));
+  }
+  if (best <= 0) return 1;
+
+  double rate = arm.gain / std::max(arm.time, SCHEDULER_MIN_TIME);
+  return std::max(SCHEDULER_MIN_PROBABILITY, rate / best);
+}
+
+void Scheduler::Select(Phase phase, std::vector<moves::PDPMove*>& selected) {
+  std::uniform_real_distribution<double> uniform(0, 1);
+  std::vector<std::pair<double, int>> weights;
+  for (int i = 0; i < (int)moves.size(); i++) {
+    double weight = Weight(phase, i);
+    if (uniform(generator) < weight) weights.push_back(std::make_pair(-weight, i));
+  }
+  std::stable_sort(weights.begin(), weights.end());
+
+  selected.clear();
+  for (const std::pair<double, int>& weight : weights) {
+    selected.push_back(moves[weight.second]);
+  }
+}
+
+void Scheduler::Update(Phase phase, const moves::PDPMove* move, double gain, double cpuTime) {
+  int i = (int)(std::find(moves.begin(), moves.end(), move) - moves.begin());
+  if (i == (int)moves.size()) return;
+
+  Arm& arm = arms[phase][i];
+  arm.gain = SCHEDULER_DECAY * arm.gain + gain;
+  arm.time = SCHEDULER_DECAY * arm.time + cpuTime;
+  arm.pulls++;
+}
+
+std::string Scheduler::Log() const {
+  static const char* phases[] = {"fast", "slow"};
+
+  std::string s = "{";
+  char buff[100];
+  for (int p = FAST; p <= SLOW; p++) {
+    s += std::string(p == FAST ? "" : ", ") + "\"" + phases[p] + "\": {";
+    for (size_t i = 0; i < moves.size(); i++) {
+      sprintf(buff, "%s\"%s\": %.4lf", i ? ", " : "", moves[i]->name().c_str(), Weight((Phase)p, (int)i));
+      s += buff;
+    }
+    s += "}";
+  }
+  return s + "}";
+}
+
+std::string Scheduler::State() const {
+  // the arms are saved by neighborhood name, their doubles bit for bit
+  std::ostringstream state;
+  for (int p = FAST; p <= SLOW; p++) {
+    for (size_t i = 0; i < moves.size(); i++) {
+      const Arm& arm = arms[p][i];
+      uint64_t gain, time;
+      memcpy(&gain, &arm.gain, sizeof(gain));
+      memcpy(&time, &arm.time, sizeof(time));
+      state << moves[i]->name() << " " << gain << " " << time << " " << arm.pulls << " ";
+    }
+  }
+  state << generator;
+  return state.str();
+}
+
+void Scheduler::Restore(const std::string& state) {
+  std::istringstream in(state);
+  for (int p = FAST; p <= SLOW; p++) {
+    for (size_t i = 0; i < moves.size(); i++) {
+      std::string name;
+      uint64_t gain, time;
+      size_t pulls;
+      in >> name >> gain >> time >> pulls;
+
+      int move = -1;
+      for (size_t j = 0; j < moves.size(); j++) {
+        if (moves[j]->name() == name) move = (int)j;
+      }
+      if (!in || move < 0) throw std::runtime_error("Checkpoint of other neighborhoods or instance");
+
+      Arm& arm = arms[p][move];
+      memcpy(&arm.gain, &gain, sizeof(gain));
+      memcpy(&arm.time, &time, sizeof(time));
+      arm.pulls = pulls;
+    }
+  }
+  in >> generator;
+  if (!in) throw std::runtime_error("Checkpoint of other neighborhoods or instance");
+}
+
+}  // namespace pdp
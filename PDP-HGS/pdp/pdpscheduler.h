@@ -0,0 +1,93 @@
+/*MIT License
+ *
+Copyright(c) 2022 Toni Pacheco
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+#ifndef PDPSCHEDULER_H
+#define PDPSCHEDULER_H
+
+#include <random>
+#include <string>
+#include <vector>
+
+#define SCHEDULER_DECAY 0.99
+#define SCHEDULER_MIN_PROBABILITY 0.05
+#define SCHEDULER_MIN_TIME 1e-3
+
+namespace pdp {
+
+namespace moves {
+class PDPMove;
+}
+
+//! Adaptive neighborhood scheduler: a multi-armed bandit over (neighborhood, phase). Each arm is
+//! rated by the improvement it brings per millisecond of evaluation, discounted at every update so the
+//! rates follow the search. A pass uses a neighborhood with probability proportional to its rate
+//! (relative to the best arm of the phase), and never lower than SCHEDULER_MIN_PROBABILITY.
+class Scheduler {
+  public:
+    //! Local search phases: per pickup node (fast) and per route (slow) neighborhoods.
+    enum Phase { FAST = 0, SLOW = 1 };
+
+    //! Scheduler constructor.
+    //! \param moves: neighborhoods to schedule.
+    //! \param seed: seed of the scheduler own random generator (the search stream is untouched).
+    Scheduler(const std::vector<moves::PDPMove*>& moves, unsigned int seed);
+
+    //! Select the neighborhoods used by a pass, sorted by decreasing rate.
+    //! \param phase: local search phase of the pass.
+    //! \param selected: selected neighborhoods (output).
+    void Select(Phase phase, std::vector<moves::PDPMove*>& selected);
+
+    //! Record the outcome of a neighborhood in a pass.
+    //! \param phase: local search phase of the pass.
+    //! \param move: neighborhood used in the pass.
+    //! \param gain: cost decrease of the moves applied.
+    //! \param cpuTime: evaluation time in milliseconds.
+    void Update(Phase phase, const moves::PDPMove* move, double gain, double cpuTime);
+
+    //! Get the probabilities of every arm as a JSON object.
+    std::string Log() const;
+
+    //! Get the arms and the random generator state (checkpoint).
+    std::string State() const;
+
+    //! Restore a state got from State.
+    //! \throw std::runtime_error: if the state belongs to other neighborhoods.
+    void Restore(const std::string& state);
+
+  private:
+    struct Arm {
+        double gain;
+        double time;
+        size_t pulls;
+    };
+
+    //! Probability of using an arm in a pass.
+    double Weight(Phase phase, int move) const;
+
+    std::vector<moves::PDPMove*> moves;
+    std::vector<Arm> arms[2];
+    std::mt19937 generator;
+};
+
+}  // namespace pdp
+
+#endif  // PDPSCHEDULER_H
@@ -0,0 +1,304 @@
+#include "pdpservice.h"
+
+#include <float.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/property_tree/json_parser.hpp>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+
+#include "hgsadc/hgsadc.h"
+#include "pdp/pdpnode.h"
+#include "pdp/pdpsolution.h"
+#include "utils/application.h"
+#include "utils/batch.h"
+#include "utils/checkpoint.h"
+#include "utils/work.h"
+
+using namespace std;
+using boost::property_tree::ptree;
+
+namespace pdp {
+
+namespace {
+
+//! Append the values of a JSON subtree to a cache key.
+void AppendKey(const ptree& tree, string& key) {
+  if (tree.empty()) {
+    key += tree.data() + ",";
+    return;
+  }
+  key += "[";
+  for (const ptree::value_type& child : tree) AppendKey(child.second, key);
+  key += "]";
+}
+
+//! Read a JSON number (or boolean, as 0 or 1).
+double Number(const ptree& tree) {
+  if (tree.data() == "true" || tree.data() == "false") return tree.data() == "true";
+  return tree.get_value<double>();
+}
+
+//! Read a JSON array of arrays of numbers.
+vector<vector<double> > Matrix(const ptree& tree) {
+  vector<vector<double> > matrix;
+  for (const ptree::value_type& row : tree) {
+    matrix.push_back(vector<double>());
+    for (const ptree::value_type& value : row.second) matrix.back().push_back(Number(value.second));
+  }
+  return matrix;
+}
+
+}  // namespace
+
+PDPService::PDPService(size_t cacheSize) : cacheSize(std::max(cacheSize, (size_t)1)), updates(0) {
+}
+
+PDPService::~PDPService() {
+  for (Cache::value_type& entry : cache) delete entry.second;
+}
+
+Server::Job PDPService::Handle(const string& line, const string& prepared, string& response,
+                               bool& preparing) {
+  string id;
+  try {
+    ptree request;
+    istringstream in(line);
+    boost::property_tree::read_json(in, request);
+    id = request.get<string>("id", "");
+
+    string key = Key(request);
+    PDPInstance* instance = Cached(key);
+    boost::optional<string> base = request.get_optional<string>("base");
+    if (!instance && base && prepared.empty())
+      throw runtime_error("Unknown base instance " + *base + " (or no longer cached).");
+
+    // budgets not given by the request are the ones of the command line
+    int seed = request.get<int>("seed", Application::seed);
+    int iterations = request.get<int>("it", Application::hgsadc_maxIterationsWithoutImprovement);
+    int timeLimit = request.get<int>("time_limit", Application::time_limit);
+    double wallLimit = request.get<double>("wall_limit", Application::wall_limit);
+    uint64_t workLimit = request.get<uint64_t>("work_limit", Work::limit);
+    // the warm start routes of an update are the previous population: they fill the population alone
+    // and are only educated around the added requests
+    bool update = (bool)request.get_child_optional("update");
+    double initialFill = request.get<double>("initial_fill", update ? 0.0 : Application::initial_fill);
+    bool initialLocal = request.get<bool>("initial_local", update || Application::initial_local);
+    bool population = request.get<bool>("population", false);
+    vector<vector<int> > initial = Application::initialRoutes;
+    if (request.get_child_optional("initial")) {
+      initial.clear();
+      for (const vector<double>& route : Matrix(request.get_child("initial")))
+        initial.push_back(vector<int>(route.begin(), route.end()));
+    }
+
+    // a new instance, or an update (re-planning), is loaded by a preparation job, the other clients not
+    // waiting for it: the daemon only builds the neighborhoods of the prepared instance and caches it
+    bool cached = instance != nullptr;
+    string updated;
+    if (!cached || update) {
+      if (prepared.empty()) {
+        preparing = true;
+        response = "{\"id\": " + Batch::Quote(id) + ", \"error\": \"preparation failed\"}";
+        const PDPInstance* loaded = instance;
+        return [request, loaded]() { return Prepare(request, loaded); };
+      }
+
+      Checkpoint::Data data(prepared);
+      if (!data.Get<bool>()) throw runtime_error(data.GetString());
+      cached = data.Get<bool>();
+      instance = PDPInstance::fromData(data);
+      if (update) {
+        // the warm start routes (e.g. the population of the previous plan) are mapped to the new nodes
+        vector<int> renumber = data.GetVector<int>();
+        for (vector<int>& route : initial) route = PDPInstance::Renumber(route, renumber);
+        updated = to_string(++updates);
+        key = "base:" + updated;
+      }
+
+      // the daemon forks its workers, so the precomputation must not start the local search threads
+      Application::instance = instance;
+      instance->Precompute();
+      Keep(key, instance);
+    }
+
+    response = "{\"id\": " + Batch::Quote(id) + ", \"error\": \"solve failed\"}";
+    return [=]() {
+      std::srand((uint)seed);
+      Application::seed = seed;
+      Application::hgsadc_maxIterationsWithoutImprovement = iterations;
+      Application::time_limit = timeLimit;
+      Application::wall_limit = wallLimit;
+      Work::limit = workLimit;
+      Application::initialRoutes = initial;
+      Application::initial_fill = initialFill;
+      Application::initial_local = initialLocal;
+      Application::BeginSolve(instance);
+
+      ga::Solution* solution = instance->CreateEmptySolution();
+      ga::HGSADC::Solve(solution, *instance);
+
+      ostringstream result;
+      result << "{\"id\": " << Batch::Quote(id);
+      result << ", \"cost\": " << solution->Cost();
+      result << ", \"time\": " << Application::Ellapsed();
+      result << ", \"work\": " << Work::Units();
+      result << ", \"feasible\": " << (solution->IsFeasible() ? "true" : "false");
+      result << ", \"cached\": " << (cached ? "true" : "false");
+      if (!updated.empty()) result << ", \"base\": " << Batch::Quote(updated);
+      result << ", \"solution\": ";
+      ((PDPSolution*)solution)->route.Print(result);
+      if (population) {
+        result << ", \"population\": [";
+        for (size_t i = 0; i < ga::HGSADC::population.size(); i++) {
+          result << (i ? ", [" : "[");
+          for (size_t j = 0; j < ga::HGSADC::population[i].size(); j++)
+            result << (j ? ", " : "") << ga::HGSADC::population[i][j];
+          result << "]";
+        }
+        result << "]";
+      }
+      result << "}";
+
+      delete solution;
+      return result.str();
+    };
+  } catch (const exception& e) {
+    response = "{\"id\": " + Batch::Quote(id) + ", \"error\": " + Batch::Quote(e.what()) + "}";
+    return Server::Job();
+  }
+}
+
+string PDPService::Key(const ptree& request) {
+  boost::optional<string> file = request.get_optional<string>("instance");
+  boost::optional<string> base = request.get_optional<string>("base");
+  bool grubhub = request.get<bool>("grubhub", Application::grubhubmode);
+
+  if (base) return "base:" + *base;
+  if (file) return (grubhub ? "grubhub:" : "rbo:") + *file;
+
+  string key = "nodes:";
+  AppendKey(request.get_child("nodes", ptree()), key);
+  AppendKey(request.get_child("distances", ptree()), key);
+  return key;
+}
+
+PDPInstance* PDPService::Cached(const string& key) {
+  unordered_map<string, Cache::iterator>::iterator found = index.find(key);
+  if (found == index.end()) return nullptr;
+  cache.splice(cache.begin(), cache, found->second);
+  return found->second->second;
+}
+
+string PDPService::Prepare(const ptree& request, const PDPInstance* instance) {
+  try {
+    Checkpoint::Data data;
+    data.Put<bool>(true);
+    data.Put<bool>(instance != nullptr);
+
+    unique_ptr<PDPInstance> loaded;
+    if (!instance) {
+      loaded.reset(Load(request));
+      loaded->PrecomputeData();
+      instance = loaded.get();
+    }
+
+    boost::optional<const ptree&> update = request.get_child_optional("update");
+    if (!update) {
+      instance->Save(data);
+      return data.Bytes();
+    }
+
+    const ptree none;
+    vector<int> removed;
+    for (const ptree::value_type& node : update->get_child("remove", none))
+      removed.push_back((int)Number(node.second));
+
+    vector<int> renumber;
+    vector<vector<double> > added = Matrix(update->get_child("add", none));
+    vector<vector<double> > distances = Matrix(update->get_child("distances", none));
+    vector<vector<double> > distancesTo = Matrix(update->get_child("distances_to", none));
+    unique_ptr<PDPInstance> updated(
+        PDPInstance::Update(*instance, added, removed, distances, distancesTo, renumber));
+    updated->Save(data);
+    data.PutVector(renumber);
+    return data.Bytes();
+  } catch (const exception& e) {
+    Checkpoint::Data data;
+    data.Put<bool>(false);
+    data.PutString(e.what());
+    return data.Bytes();
+  }
+}
+
+PDPInstance* PDPService::Load(const ptree& request) {
+  boost::optional<string> file = request.get_optional<string>("instance");
+  if (!file) return FromRequest(request);
+  if (!boost::filesystem::is_regular_file(*file)) throw runtime_error("Instance file not found: " + *file);
+
+  bool grubhubmode = Application::grubhubmode;
+  Application::grubhubmode = request.get<bool>("grubhub", grubhubmode);
+  PDPInstance* instance = PDPInstance::fromFilePath(*file);
+  Application::grubhubmode = grubhubmode;
+
+  if (!instance || instance->Size() < 3 || instance->Size() % 2 == 0) {
+    delete instance;
+    throw runtime_error("Invalid instance file: " + *file);
+  }
+  return instance;
+}
+
+void PDPService::Keep(const string& key, PDPInstance* instance) {
+  cache.push_front(make_pair(key, instance));
+  index[key] = cache.begin();
+  if (cache.size() > cacheSize) {
+    index.erase(cache.back().first);
+    delete cache.back().second;
+    cache.pop_back();
+  }
+}
+
+PDPInstance* PDPService::FromRequest(const ptree& request) {
+  if (!request.get_child_optional("nodes")) throw runtime_error("The request needs an instance or nodes.");
+
+  // a node is [x, y, pair, pickup], node 0 being the depot
+  vector<vector<double> > rows = Matrix(request.get_child("nodes"));
+  vector<vector<double> > distances = Matrix(request.get_child("distances", ptree()));
+  int n = (int)rows.size();
+
+  if (n < 3 || n % 2 == 0) throw runtime_error("The instance needs a depot and pickup-delivery pairs.");
+  for (int i = 0; i < n; i++) {
+    if (rows[i].size() != 4) throw runtime_error("A node is [x, y, pair, pickup].");
+  }
+  for (int i = 1; i < n; i++) {
+    int pair = (int)rows[i][2];
+    bool pickup = rows[i][3] != 0;
+    if (pair < 1 || pair >= n || pair == i || (int)rows[pair][2] != i || (rows[pair][3] != 0) == pickup)
+      throw runtime_error("Node " + to_string(i) + " is not paired with a node of the other type.");
+  }
+  if (!distances.empty()) {
+    if ((int)distances.size() != n) throw runtime_error("The distance matrix is not n x n.");
+    for (const vector<double>& row : distances) {
+      if ((int)row.size() != n) throw runtime_error("The distance matrix is not n x n.");
+    }
+  }
+
+  NodeList nodes;
+  for (int i = 0; i < n; i++) {
+    PDPNode* node = new PDPNode();
+    node->idx = i;
+    node->x = rows[i][0];
+    node->y = rows[i][1];
+    node->pair = i > 0 ? (int)rows[i][2] : 0;
+    node->isPickup = i > 0 && rows[i][3] != 0;
+    node->isDelivery = i > 0 && rows[i][3] == 0;
+    nodes.push_back(node);
+  }
+
+  PDPInstance* instance = new PDPInstance(std::max(Application::hgsadc_cl, 1), nodes);
+  if (!distances.empty()) instance->SetDistances(distances);
+  return instance;
+}
+
+}  // namespace pdp
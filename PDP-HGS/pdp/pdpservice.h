@@ -0,0 +1,93 @@
+/*MIT License
+ *
+Copyright(c) 2022 Toni Pacheco
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+#ifndef PDPSERVICE_H
+#define PDPSERVICE_H
+
+#include <boost/property_tree/ptree.hpp>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "pdp/pdpinstance.h"
+#include "utils/server.h"
+
+namespace pdp {
+
+//! Solve requests of the --serve daemon (a JSON object per line). The instances of the last requests
+//! are kept precomputed (distance matrix, closest customers, neighborhoods and Balas&Simonetti graph),
+//! so that a repeated instance is solved without any precomputation. A request can also add and remove
+//! requests of an instance (re-planning), the updated instance being cached as a base for the next changes.
+//! A new or updated instance is loaded by a preparation job, the daemon only building its neighborhoods.
+class PDPService {
+  public:
+    //! Constructor
+    //! \param cacheSize: number of precomputed instances kept.
+    explicit PDPService(size_t cacheSize);
+
+    //! Destructor
+    ~PDPService();
+
+    //! Prepare a request and return its solve job, or its preparation job (see Server::Handler).
+    Server::Job Handle(const std::string& request, const std::string& prepared, std::string& response,
+                       bool& preparing);
+
+  private:
+    typedef std::list<std::pair<std::string, PDPInstance*> > Cache;
+
+    //! Cache key of the instance of a request (the base of an update).
+    static std::string Key(const boost::property_tree::ptree& request);
+
+    //! Get a cached instance, as the most recently used one.
+    //! \return PDPInstance*: the instance, or nullptr if it's not cached.
+    PDPInstance* Cached(const std::string& key);
+
+    //! Preparation job of a request: load its instance unless it's cached, and apply its update.
+    //! \param instance: cached instance of the request, or nullptr.
+    //! \return std::string: the instance with its distances and closest customers (see
+    //! PDPInstance::Save), then the renumbering of an update, or the error of the request.
+    static std::string Prepare(const boost::property_tree::ptree& request, const PDPInstance* instance);
+
+    //! Load the instance of a request, from its file or its nodes.
+    static PDPInstance* Load(const boost::property_tree::ptree& request);
+
+    //! Load the instance given inline in a request.
+    static PDPInstance* FromRequest(const boost::property_tree::ptree& request);
+
+    //! Add a precomputed instance to the cache, dropping the least recently used one if it's full.
+    void Keep(const std::string& key, PDPInstance* instance);
+
+    //! Number of precomputed instances kept.
+    const size_t cacheSize;
+
+    //! Precomputed instances by key, the most recently used first.
+    Cache cache;
+    std::unordered_map<std::string, Cache::iterator> index;
+
+    //! Number of updated instances, naming the next one.
+    size_t updates;
+};
+
+}  // namespace pdp
+
+#endif  // PDPSERVICE_H
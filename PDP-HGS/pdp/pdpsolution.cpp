@@ -1,5 +1,6 @@
 #include "pdpsolution.h"
 
+#include <algorithm>
 #include <iostream>
 
 #include "pdp/pdpinstance.h"
@@ -10,8 +11,13 @@ namespace pdp {
 
 using namespace std;
 
+std::atomic<size_t> PDPSolution::versionCounter(0);
+
 PDPSolution::PDPSolution() {
   idx = -1;
+  positionsRouteSize = 0;
+  version = ++versionCounter;
+  dirtyCount = 0;
 }
 
 PDPSolution::PDPSolution(const PDPSolution& s) {
@@ -21,6 +27,11 @@ PDPSolution::PDPSolution(const PDPSolution& s) {
 const PDPSolution& PDPSolution::operator=(const PDPSolution& s) {
   cost = s.cost;
   positions = s.positions;
+  positionsRouteSize = s.positionsRouteSize;
+
+  version = s.version;
+  dirtyCount = s.dirtyCount;
+  std::copy(s.dirty, s.dirty + s.dirtyCount, dirty);
 
   route = s.route;
 
@@ -76,12 +87,75 @@ void PDPSolution::Recompute() {
 }
 
 void PDPSolution::ComputePositions() {
-  positions.resize(Application::instance->Size());
-  std::fill(positions.begin(), positions.end(), -1);
+  positions.resize(Application::instance->Size(), -1);
+
+  // detecting the range of the route that changed since last computation
+  int begin = INT_MAX;
+  int end = -1;
+  for (size_t i = 1; i < route.size() - 1; i++) {
+    if (positions[route[i]] != (int)i) {
+      begin = std::min(begin, (int)i);
+      end = (int)i;
+    }
+  }
+  if (route.size() != positionsRouteSize) {
+    begin = std::min(begin, (int)std::min(route.size(), positionsRouteSize) - 1);
+    end = std::max(end, (int)std::max(route.size(), positionsRouteSize) - 1);
+  }
 
+  std::fill(positions.begin(), positions.end(), -1);
   for (size_t i = 1; i < route.size() - 1; i++) {
     positions[route[i]] = i;
   }
+  positionsRouteSize = route.size();
+
+  if (begin <= end) {
+    MarkDirty(std::max(begin, 0), end);
+  }
+}
+
+void PDPSolution::MarkDirty(int begin, int end) {
+  if (dirtyCount == DIRTY_HISTORY) {
+    std::copy(dirty + 1, dirty + DIRTY_HISTORY, dirty);
+    dirtyCount--;
+  }
+
+  dirty[dirtyCount].from = version;
+  dirty[dirtyCount].begin = begin;
+  dirty[dirtyCount].end = end;
+  dirtyCount++;
+
+  version = ++versionCounter;
+}
+
+bool PDPSolution::ChangedSince(size_t since, int& begin, int& end) const {
+  if (since == version) return false;
+
+  begin = INT_MAX;
+  end = -1;
+  for (int h = dirtyCount - 1; h >= 0; h--) {
+    begin = std::min(begin, dirty[h].begin);
+    end = std::max(end, dirty[h].end);
+    if (dirty[h].from == since) return true;
+  }
+
+  begin = 0;
+  end = (int)route.size() - 1;
+  return true;
+}
+
+int PDPSolution::ChangedRangesSince(size_t since, int* begins, int* ends) const {
+  if (since == version) return 0;
+
+  int count = 0;
+  for (int h = dirtyCount - 1; h >= 0; h--) {
+    begins[count] = dirty[h].begin;
+    ends[count] = dirty[h].end;
+    count++;
+    if (dirty[h].from == since) return count;
+  }
+
+  return -1;
 }
 
 int PDPSolution::FindPosition(int k) const {
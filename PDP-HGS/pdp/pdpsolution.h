@@ -24,6 +24,7 @@ SOFTWARE.*/
 #define PDPSOLUTION_H
 #include <limits.h>
 
+#include <atomic>
 #include <iostream>
 #include <vector>
 
@@ -32,6 +33,9 @@ SOFTWARE.*/
 
 class Instance;
 
+//! Number of route changes remembered by a solution for dirty-region queries.
+#define DIRTY_HISTORY 16
+
 namespace pdp {
 
 class PDPSolution : public ga::Solution {
@@ -84,21 +88,76 @@ class PDPSolution : public ga::Solution {
     //! Print solution state
     virtual void Print(std::ostream& os = std::cout) const;
 
+    //! Get the customers in visit order (depot included).
+    virtual std::vector<int> Visits() const {
+      return route;
+    }
+
     //! Get customer postion
     //! \param k: id of customer
     //! \return int: route and in-route index of the given customer.
     int FindPosition(int k) const;
 
+    //! Get the in-route index of every customer (-1 for the depot).
+    const int* Positions() const {
+      return positions.data();
+    }
+
     //! Assignment operator
     const PDPSolution& operator=(const PDPSolution&);
 
     virtual double Cost() const;
 
+    //! Get route version. Every change of the route gets a new (process-wide unique) version,
+    //! so two solutions sharing a version hold the same route.
+    size_t Version() const {
+      return version;
+    }
+
+    //! Check if route changed since a given version.
+    //! \param since: version previously seen by the caller.
+    //! \return bool: false if the route still is at the given version.
+    bool ChangedSince(size_t since) const {
+      return since != version;
+    }
+
+    //! Check if route changed since a given version and get the touched index range.
+    //! \param since: version previously seen by the caller.
+    //! \param begin: first route index changed since then.
+    //! \param end: last route index changed since then.
+    //! \return bool: false if the route still is at the given version. When the history
+    //! does not reach the given version, the whole route is reported as changed.
+    bool ChangedSince(size_t since, int& begin, int& end) const;
+
+    //! Get the index ranges touched by each route change since a given version.
+    //! \param since: version previously seen by the caller.
+    //! \param begins: first route index of each change (room for DIRTY_HISTORY ranges).
+    //! \param ends: last route index of each change (room for DIRTY_HISTORY ranges).
+    //! \return int: number of changes, or -1 if the history does not reach the given version.
+    int ChangedRangesSince(size_t since, int* begins, int* ends) const;
+
   public:
     pdp::PDPRoute route;
 
   private:
+    //! Record a route change on [begin, end] and move to a new version.
+    void MarkDirty(int begin, int end);
+
+    //! Route range touched when leaving a version.
+    struct DirtyRange {
+        size_t from;
+        int begin;
+        int end;
+    };
+
     std::vector<int> positions;
+    size_t positionsRouteSize;
+
+    size_t version;
+    DirtyRange dirty[DIRTY_HISTORY];
+    int dirtyCount;
+
+    static std::atomic<size_t> versionCounter;
 };
 
 }  // namespace pdp
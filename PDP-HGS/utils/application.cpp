@@ -1,15 +1,32 @@
 #include "application.h"
 
+#include <algorithm>
 #include <boost/algorithm/string.hpp>
+#include <iomanip>
 #include <iostream>
+#include <set>
+#include <sstream>
 #include <string>
 
+#include "utils/profiler.h"
+#include "utils/trace.h"
+#include "utils/work.h"
+
 using namespace std;
 
 bool Application::verbose = false;
 int Application::time_limit;
+double Application::wall_limit;
+int Application::seed;
 int Application::bs_k;
+int Application::bs_cache_mb;
+int Application::bs_window;
+int Application::bs_parallel;
 int Application::or_k;
+int Application::k2opt_len;
+int Application::opt4_granular;
+int Application::threads;
+int Application::parallel_nb;
 
 int Application::hgsadc_populationSize;
 int Application::hgsadc_maxIterationsWithoutImprovement;
@@ -20,6 +37,7 @@ int Application::hgsadc_cl;
 
 std::string Application::neighborhoods;
 double Application::slow_nb_percentage;
+int Application::adaptive_nb;
 bool Application::ls_2kopt = false;
 bool Application::ls_relocate = false;
 bool Application::ls_2opt = false;
@@ -33,10 +51,26 @@ bool Application::firstimprovement = false;
 std::vector<Application::EvolutionEntry> Application::evolution;
 size_t Application::evolutionCount;
 double Application::bestCost;
+std::function<void(const ga::Solution*)> Application::improvement;
 
 clock_t Application::startTime = 0.0;
+std::chrono::steady_clock::time_point Application::wallStartTime;
 
 std::string Application::instanceFile;
+std::string Application::traceFile;
+std::vector<std::string> Application::initialFiles;
+std::vector<std::vector<int> > Application::initialRoutes;
+double Application::initial_fill;
+int Application::initial_local;
+std::string Application::checkpointFile;
+double Application::checkpoint_every;
+std::string Application::resumeFile;
+std::string Application::searchOptions;
+std::string Application::batchPath;
+int Application::batch_jobs;
+std::string Application::servePath;
+int Application::serve_jobs;
+int Application::serve_cache;
 ga::Problem *Application::instance;
 
 template <typename T>
@@ -44,6 +78,18 @@ inline boost::program_options::typed_value<T> *default_param(T value) {
   return boost::program_options::value<T>()->default_value(value);
 }
 
+//! Value of an option as text (empty for a flag).
+string OptionText(const boost::any &value) {
+  ostringstream text;
+  text << setprecision(17);
+  if (const int *v = boost::any_cast<int>(&value)) text << *v;
+  if (const double *v = boost::any_cast<double>(&value)) text << *v;
+  if (const uint64_t *v = boost::any_cast<uint64_t>(&value)) text << *v;
+  if (const bool *v = boost::any_cast<bool>(&value)) text << *v;
+  if (const string *v = boost::any_cast<string>(&value)) text << *v;
+  return text.str();
+}
+
 boost::program_options::variables_map Application::initializeVariablesMap(int argc, char *argv[]) {
   boost::program_options::variables_map variablesMap;
 
@@ -56,21 +102,92 @@ boost::program_options::variables_map Application::initializeVariablesMap(int ar
 
   add_option("verbose", boost::program_options::bool_switch(), "Enable verbose mode.");
 
+  add_option("profile", boost::program_options::bool_switch(),
+             "Print a JSON profile of the neighborhoods and of the offspring generation phases.");
+
+  add_option("trace", default_param(std::string("")), "Write a Chrome trace of the run to the given file.");
+
   add_option("instance", boost::program_options::value<string>(), "Instance file path.");
 
+  add_option("batch", default_param(std::string("")),
+             "Solve the instances of a directory or of a list file (a path per line), printing a JSON line "
+             "per instance.");
+
+  add_option("batch-jobs", default_param(DEFAULT_BATCH_JOBS),
+             "Instances of a batch solved concurrently (0 for the number of cores).");
+
+  add_option("serve", default_param(std::string("")),
+             "Serve JSON line solve requests on a Unix socket, or on the standard input and output (-).");
+
+  add_option("serve-jobs", default_param(DEFAULT_SERVE_JOBS),
+             "Requests solved concurrently by the daemon (0 for the number of cores).");
+
+  add_option("serve-cache", default_param(DEFAULT_SERVE_CACHE), "Precomputed instances kept by the daemon.");
+
   add_option("grubhub", "Read file as a distance matrix (GrubHub format).");
 
+  add_option("initial", boost::program_options::value<std::vector<string> >()->composing(),
+             "Solution file (.sol, pdphgs output or list of nodes) seeding the initial population, repaired "
+             "if needed. Can be given several times.");
+
+  add_option("initial-fill", default_param(DEFAULT_INITIAL_FILL),
+             "Fraction of the random initial population still built with --initial solutions.");
+
+  add_option("initial-local", default_param(DEFAULT_INITIAL_LOCAL),
+             "The --initial solutions are local optima (e.g. a previous population), only educated "
+             "around the requests they miss (0 or 1).");
+
+  add_option("checkpoint", default_param(std::string("")),
+             "Periodically write a snapshot of the run to the given file, to continue it with --resume.");
+
+  add_option("checkpoint-every", default_param(double(DEFAULT_CHECKPOINT_EVERY)),
+             "Seconds between two snapshots of --checkpoint.");
+
+  add_option("resume", default_param(std::string("")),
+             "Continue the run of a --checkpoint snapshot (same instance and parameters).");
+
   add_option("seed", default_param(DEFAULT_SEED), "Sets a random seed.");
 
   add_option("time-limit", default_param(INT_MAX), "Set the maximum execution time in seconds.");
 
+  add_option("wall-limit", default_param(0.0),
+             "Set the maximum wall-clock time in seconds (0 for none). --time-limit counts the CPU time of "
+             "every --threads thread.");
+
+  add_option("work-limit", default_param(uint64_t(DEFAULT_WORK_LIMIT)),
+             "Set the maximum work in deterministic units (evaluated moves, dynamic programming cells and "
+             "arcs), 0 for unlimited.");
+
   add_option("bs-k", default_param(DEFAULT_BS_K), "Balas&Simonetti k parameter.");
 
+  add_option("bs-cache-mb", default_param(DEFAULT_BS_CACHE_MB),
+             "Balas&Simonetti cache size in megabytes (0 disables the cache).");
+
+  add_option("bs-window", default_param(DEFAULT_BS_WINDOW),
+             "Balas&Simonetti only reorders the range changed since its last local optimum (0 or 1).");
+
+  add_option("bs-parallel", default_param(DEFAULT_BS_PARALLEL),
+             "Balas&Simonetti reorders blocks of long routes in parallel (0 or 1).");
+
   add_option("or-k", default_param(DEFAULT_OR_K), "Or-Opt k parameter.");
 
+  add_option("2kopt-len", default_param(DEFAULT_2KOPT_LEN),
+             "2k-Opt maximum reversal length (0 for unlimited).");
+
+  add_option("4opt-granular", default_param(DEFAULT_4OPT_GRANULAR),
+             "4-Opt candidate neighbors per customer (0 for the full neighborhood).");
+
+  add_option("threads", default_param(DEFAULT_THREADS), "Number of threads used by the local search.");
+
+  add_option("parallel-nb", default_param(DEFAULT_PARALLEL_NB),
+             "Slow neighborhoods are evaluated concurrently (0 or 1).");
+
   add_option("ratio-slow-nb", default_param(DEFAULT_SLOW_NB),
              "Ratio of slow neigborhods usage in local searches.");
 
+  add_option("adaptive-nb", default_param(DEFAULT_ADAPTIVE_NB),
+             "Neighborhoods are scheduled by their gain per millisecond (0 or 1).");
+
   add_option("neighborhoods", default_param(DEFAULT_NEIGHBORHOODS), "Select neighborhood structure.");
 
   add_option("mu", default_param(DEFAULT_POPULATION_SIZE), "Minimum population size.");
@@ -110,14 +227,49 @@ boost::program_options::variables_map Application::initializeVariablesMap(int ar
 void Application::LoadArgs(boost::program_options::variables_map variablesMap) {
   // verbosity
   verbose = variablesMap["verbose"].as<bool>();
+  Profile::enabled = variablesMap["profile"].as<bool>();
+
+  traceFile = variablesMap["trace"].as<string>();
+  if (!traceFile.empty()) Trace::Open(traceFile);
 
   time_limit = variablesMap["time-limit"].as<int>();
+  wall_limit = std::max(0.0, variablesMap["wall-limit"].as<double>());
+  Work::limit = variablesMap["work-limit"].as<uint64_t>();
+
+  seed = variablesMap["seed"].as<int>();
 
   // Instance
-  instanceFile = variablesMap["instance"].as<string>();
+  instanceFile = variablesMap.count("instance") ? variablesMap["instance"].as<string>() : "";
+  batchPath = variablesMap["batch"].as<string>();
+  batch_jobs = variablesMap["batch-jobs"].as<int>();
+  servePath = variablesMap["serve"].as<string>();
+  serve_jobs = variablesMap["serve-jobs"].as<int>();
+  serve_cache = variablesMap["serve-cache"].as<int>();
 
   grubhubmode = variablesMap.count("grubhub") > 0;
 
+  // warm start, the files being read once the arguments are loaded
+  initialFiles = variablesMap.count("initial") ? variablesMap["initial"].as<std::vector<string> >()
+                                               : std::vector<string>();
+  initial_fill = std::max(0.0, variablesMap["initial-fill"].as<double>());
+  initial_local = variablesMap["initial-local"].as<int>();
+
+  checkpointFile = variablesMap["checkpoint"].as<string>();
+  checkpoint_every = std::max(0.0, variablesMap["checkpoint-every"].as<double>());
+  resumeFile = variablesMap["resume"].as<string>();
+
+  // the files, outputs and budgets of a resumed run may differ from the ones of its snapshot
+  static const std::set<string> runOptions = {"help",       "version",    "verbose",          "profile",
+                                              "trace",      "instance",   "batch",            "batch-jobs",
+                                              "serve",      "serve-jobs", "serve-cache",      "initial",
+                                              "checkpoint", "resume",     "checkpoint-every", "time-limit",
+                                              "wall-limit", "work-limit", "it",               "threads"};
+  searchOptions.clear();
+  for (const pair<const string, boost::program_options::variable_value> &option : variablesMap) {
+    if (!runOptions.count(option.first))
+      searchOptions += option.first + "=" + OptionText(option.second.value()) + " ";
+  }
+
   // HGS
   hgsadc_populationSize = variablesMap["mu"].as<int>();
 
@@ -133,8 +285,16 @@ void Application::LoadArgs(boost::program_options::variables_map variablesMap) {
 
   // NEIGHBORHOOD
   bs_k = (int)variablesMap["bs-k"].as<int>();
+  bs_cache_mb = std::max(0, (int)variablesMap["bs-cache-mb"].as<int>());
+  bs_window = (int)variablesMap["bs-window"].as<int>();
+  bs_parallel = (int)variablesMap["bs-parallel"].as<int>();
   or_k = (int)variablesMap["or-k"].as<int>();
+  k2opt_len = (int)variablesMap["2kopt-len"].as<int>();
+  opt4_granular = std::max(0, (int)variablesMap["4opt-granular"].as<int>());
+  threads = std::max(1, (int)variablesMap["threads"].as<int>());
+  parallel_nb = (int)variablesMap["parallel-nb"].as<int>();
   slow_nb_percentage = variablesMap["ratio-slow-nb"].as<double>();
+  adaptive_nb = (int)variablesMap["adaptive-nb"].as<int>();
   neighborhoods = boost::to_upper_copy<std::string>(variablesMap["neighborhoods"].as<string>());
   ls_relocate = ls_2opt = ls_2kopt = ls_4opt_cd = ls_4opt_dc = ls_4opt_dd = ls_bs = false;
 
@@ -159,6 +319,15 @@ void Application::PrintParameters() {
   cout << "\t  --it=" << hgsadc_maxIterationsWithoutImprovement << endl;
   cout << "\t  --div=" << hgsadc_divIterationsWithoutImprovement << endl;
   cout << "\t  --time-limit=" << time_limit << endl;
+  cout << "\t  --wall-limit=" << wall_limit << endl;
+  cout << "\t  --work-limit=" << Work::limit << endl;
+
+  for (const string& file : initialFiles) cout << "\t  --initial=" << file << endl;
+  cout << "\t  --initial-fill=" << initial_fill << endl;
+  cout << "\t  --initial-local=" << initial_local << endl;
+  cout << "\t  --checkpoint=" << checkpointFile << endl;
+  cout << "\t  --checkpoint-every=" << checkpoint_every << endl;
+  cout << "\t  --resume=" << resumeFile << endl;
 
   cout << "\t  --mu=" << hgsadc_populationSize << endl;
   cout << "\t  --lambda=" << hgsadc_offspringInGeneration << endl;
@@ -168,15 +337,46 @@ void Application::PrintParameters() {
   // NEIGHBORHOOD
   cout << "\t  --neighborhoods=" << neighborhoods << endl;
   cout << "\t  --bs-k=" << bs_k << endl;
+  cout << "\t  --bs-cache-mb=" << bs_cache_mb << endl;
+  cout << "\t  --bs-window=" << bs_window << endl;
+  cout << "\t  --bs-parallel=" << bs_parallel << endl;
   cout << "\t  --or-k=" << or_k << endl;
+  cout << "\t  --2kopt-len=" << k2opt_len << endl;
+  cout << "\t  --4opt-granular=" << opt4_granular << endl;
+  cout << "\t  --threads=" << threads << endl;
+  cout << "\t  --parallel-nb=" << parallel_nb << endl;
+  cout << "\t  --adaptive-nb=" << adaptive_nb << endl;
+  cout << "\t  --profile=" << Profile::enabled << endl;
+  cout << "\t  --trace=" << traceFile << endl;
+  cout << "\t  --batch=" << batchPath << endl;
+  cout << "\t  --batch-jobs=" << batch_jobs << endl;
+  cout << "\t  --serve=" << servePath << endl;
+  cout << "\t  --serve-jobs=" << serve_jobs << endl;
+  cout << "\t  --serve-cache=" << serve_cache << endl;
 }
 
 double Application::Ellapsed() {
   return static_cast<double>(clock() - startTime) / CLOCKS_PER_SEC;
 }
 
+double Application::WallEllapsed() {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStartTime).count();
+}
+
 bool Application::Timeout() {
-  return Application::time_limit < Application::Ellapsed();
+  return Application::time_limit < Application::Ellapsed() ||
+         (Application::wall_limit > 0 && Application::wall_limit < Application::WallEllapsed()) ||
+         Work::Exhausted();
+}
+
+void Application::BeginSolve(ga::Problem* problem) {
+  instance = problem;
+  if (!problem->Precomputed()) problem->Precompute();
+
+  Work::Reset();
+  startTime = clock();
+  wallStartTime = std::chrono::steady_clock::now();
+  ClearLogEvolution();
 }
 
 void Application::ClearLogEvolution() {
@@ -184,10 +384,12 @@ void Application::ClearLogEvolution() {
   bestCost = DBL_MAX;
   evolution.clear();
 }
-void Application::LogEvolution(double cost) {
+void Application::LogEvolution(const ga::Solution* solution) {
+  double cost = solution->Cost();
   evolutionCount++;
   if (cost < bestCost) {
     evolution.push_back(EvolutionEntry(evolutionCount, Ellapsed(), cost));
     bestCost = cost;
+    if (improvement) improvement(solution);
   }
 }
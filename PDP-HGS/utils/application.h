@@ -27,6 +27,13 @@ SOFTWARE.*/
 #define STRINGIZE_VALUE_OF(x) TOSTR_(x)
 
 #define DEFAULT_SEED 0
+#define DEFAULT_WORK_LIMIT 0
+#define DEFAULT_BATCH_JOBS 0
+#define DEFAULT_SERVE_JOBS 0
+#define DEFAULT_SERVE_CACHE 8
+#define DEFAULT_INITIAL_FILL 1.0
+#define DEFAULT_INITIAL_LOCAL 0
+#define DEFAULT_CHECKPOINT_EVERY 60
 #define DEFAULT_ELITE 1
 #define DEFAULT_CLOSE 2
 #define DEFAULT_POPULATION_SIZE 25
@@ -36,14 +43,24 @@ SOFTWARE.*/
 #define DEFAULT_NEIGHBORHOODS std::string("RELOCATE-2OPT-2KOPT-OROPT-4OPT-BS")
 
 #define DEFAULT_BS_K 3
+#define DEFAULT_BS_CACHE_MB 0
+#define DEFAULT_BS_WINDOW 0
+#define DEFAULT_BS_PARALLEL 0
 #define DEFAULT_OR_K 30
+#define DEFAULT_2KOPT_LEN 0
+#define DEFAULT_4OPT_GRANULAR 0
 #define DEFAULT_SLOW_NB 1.0
+#define DEFAULT_THREADS 1
+#define DEFAULT_PARALLEL_NB 0
+#define DEFAULT_ADAPTIVE_NB 0
 
 #include <float.h>
 #include <limits.h>
 
 #include <boost/filesystem.hpp>
 #include <boost/program_options.hpp>
+#include <chrono>
+#include <functional>
 
 #include "hgsadc/problem.h"
 
@@ -53,11 +70,19 @@ class Application {
 
     static double Ellapsed();
 
+    //! Wall-clock seconds since the start of the solve (Ellapsed counts the CPU time of every thread).
+    static double WallEllapsed();
+
     static bool Timeout();
 
-    static void LogEvolution(double cost);
+    static void LogEvolution(const ga::Solution* solution);
     static void ClearLogEvolution();
 
+    //! Start a solve of an instance: precompute it unless it already is (e.g. cached by the daemon), then
+    //! reset the clock, the work and the evolution log of the run.
+    //! \param problem: instance solved, becoming Application::instance.
+    static void BeginSolve(ga::Problem* problem);
+
   public:
     typedef struct _EvolutionEntry {
         size_t iteration;
@@ -80,21 +105,51 @@ class Application {
     //! Execution time limit in ms.
     static int time_limit;
 
+    //! Wall-clock time limit in seconds (0 for none).
+    static double wall_limit;
+
+    //! Random seed.
+    static int seed;
+
     //! Flag of verbose mode.
     static bool verbose;
 
     //! Balas&Simonetti k parameter.
     static int bs_k;
 
+    //! Balas&Simonetti cache size in megabytes (0 disables the cache).
+    static int bs_cache_mb;
+
+    //! Balas&Simonetti only reorders the range changed since its last local optimum (0 or 1).
+    static int bs_window;
+
+    //! Balas&Simonetti reorders blocks of long routes in parallel (0 or 1).
+    static int bs_parallel;
+
     //! Or-Opt k parameter.
     static int or_k;
 
+    //! 2k-Opt maximum reversal length (0 for unlimited).
+    static int k2opt_len;
+
+    //! 4-Opt candidate neighbors per customer (0 for the full neighborhood).
+    static int opt4_granular;
+
+    //! Number of threads used by the local search.
+    static int threads;
+
+    //! Slow neighborhoods are evaluated concurrently (0 or 1).
+    static int parallel_nb;
+
     //! Local search neighborhood.
     static std::string neighborhoods;
 
     //! Percentage of slow neighborhood usage.
     static double slow_nb_percentage;
 
+    //! Neighborhoods are scheduled by their gain per millisecond (0 or 1).
+    static int adaptive_nb;
+
     //! Local search K2-OPT neighborhood.
     static bool ls_2kopt;
 
@@ -122,6 +177,50 @@ class Application {
     //! Path for instance file.
     static std::string instanceFile;
 
+    //! Solution files of the warm start.
+    static std::vector<std::string> initialFiles;
+
+    //! Visit orders of the warm start, seeding the initial population.
+    static std::vector<std::vector<int> > initialRoutes;
+
+    //! Fraction of the random initial population still built with a warm start.
+    static double initial_fill;
+
+    //! The warm start solutions are local optima but for the requests they miss, which are inserted and
+    //! educated locally (re-planning from a previous population).
+    static int initial_local;
+
+    //! Snapshot file of the run (empty if checkpoints are disabled).
+    static std::string checkpointFile;
+
+    //! Seconds between two snapshots of the run.
+    static double checkpoint_every;
+
+    //! Snapshot file the run continues from (empty for a new run).
+    static std::string resumeFile;
+
+    //! Options steering the search, as name=value, that a resumed run must share with its snapshot (all
+    //! but the files, the outputs, the budgets and --threads).
+    static std::string searchOptions;
+
+    //! Path for the Chrome trace file (empty if tracing is disabled).
+    static std::string traceFile;
+
+    //! Directory or list file of the instances solved in batch (empty for a single instance).
+    static std::string batchPath;
+
+    //! Instances of a batch solved concurrently (0 for the number of cores).
+    static int batch_jobs;
+
+    //! Unix socket of the solve daemon, or "-" for the standard input and output (empty for no daemon).
+    static std::string servePath;
+
+    //! Requests of the daemon solved concurrently (0 for the number of cores).
+    static int serve_jobs;
+
+    //! Precomputed instances kept by the daemon.
+    static int serve_cache;
+
     //! Problem instance handler.
     static ga::Problem* instance;
 
@@ -155,6 +254,9 @@ class Application {
     //! Current best cost
     static double bestCost;
 
+    //! Called with each new best solution (embedding API).
+    static std::function<void(const ga::Solution*)> improvement;
+
     //! Set instance as edge mode (grubhub)
     static bool grubhubmode;
 
@@ -162,6 +264,7 @@ class Application {
     static bool firstimprovement;
 
     static clock_t startTime;
+    static std::chrono::steady_clock::time_point wallStartTime;
 };
 
 #endif  // APPLICATION_H
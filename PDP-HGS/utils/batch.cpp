@@ -0,0 +1,181 @@
+#include "batch.h"
+
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <boost/algorithm/string.hpp>
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+using namespace std;
+
+namespace {
+
+//! Worker process solving one instance.
+struct Worker {
+    pid_t pid;
+
+    //! read end of the pipe receiving the result line.
+    int fd;
+
+    std::string instance;
+    std::string output;
+};
+
+//! Write a whole buffer to a file descriptor.
+bool WriteAll(int fd, const string& buffer) {
+  size_t written = 0;
+  while (written < buffer.size()) {
+    ssize_t n = write(fd, buffer.data() + written, buffer.size() - written);
+    if (n <= 0) return false;
+    written += n;
+  }
+  return true;
+}
+
+//! Run a job in the forked worker and send its line through the pipe.
+void RunWorker(int fd, const function<string()>& job) {
+  int status = 1;
+  try {
+    if (WriteAll(fd, job() + "\n")) status = 0;
+  } catch (const exception& e) {
+    cerr << e.what() << endl;
+  }
+  close(fd);
+  cout.flush();
+  _exit(status);  // no exit handlers, they belong to the parent
+}
+
+//! Number of threads of the process (0 if unknown, e.g. without /proc).
+int ProcessThreads() {
+  boost::system::error_code error;
+  boost::filesystem::directory_iterator task("/proc/self/task", error);
+  if (error) return 0;
+  return (int)distance(task, boost::filesystem::directory_iterator());
+}
+
+}  // namespace
+
+vector<string> Batch::Instances(const string& path) {
+  vector<string> instances;
+
+  if (boost::filesystem::is_directory(path)) {
+    for (const boost::filesystem::directory_entry& entry : boost::filesystem::directory_iterator(path)) {
+      if (!boost::filesystem::is_regular_file(entry.path())) continue;
+      if (boost::algorithm::iequals(entry.path().extension().string(), ".sol")) continue;
+      instances.push_back(entry.path().string());
+    }
+    sort(instances.begin(), instances.end());
+    return instances;
+  }
+
+  ifstream in(path);
+  string line;
+  while (getline(in, line)) {
+    boost::algorithm::trim(line);
+    if (!line.empty() && line[0] != '#') instances.push_back(line);
+  }
+  return instances;
+}
+
+int Batch::Run(const vector<string>& instances, int jobs, const function<string(const string&)>& solve) {
+  if (jobs <= 0) jobs = max(1, (int)thread::hardware_concurrency());
+
+  vector<Worker> workers;
+  size_t next = 0;
+  int failures = 0;
+  char buffer[4096];
+
+  while (next < instances.size() || !workers.empty()) {
+    while ((int)workers.size() < jobs && next < instances.size()) {
+      const string& instance = instances[next++];
+      int fd;
+      pid_t pid = Fork([&solve, &instance]() { return solve(instance); }, fd);
+      if (pid < 0) {
+        // the instance fails, the running workers are still waited for
+        failures++;
+        cout << "{\"instance\": " << Quote(instance) << ", \"error\": \"cannot start the worker\"}" << endl;
+        continue;
+      }
+      workers.push_back({pid, fd, instance, ""});
+    }
+    if (workers.empty()) continue;
+
+    vector<pollfd> polls;
+    for (const Worker& worker : workers) polls.push_back({worker.fd, POLLIN, 0});
+    if (poll(polls.data(), polls.size(), -1) < 0) continue;
+
+    for (int i = (int)workers.size() - 1; i >= 0; i--) {
+      if (!polls[i].revents) continue;
+
+      Worker& worker = workers[i];
+      ssize_t n = read(worker.fd, buffer, sizeof(buffer));
+      if (n > 0) {
+        worker.output.append(buffer, n);
+        continue;
+      }
+      if (n < 0 && errno == EINTR) continue;
+
+      // end of the result: the worker is done
+      close(worker.fd);
+      int status;
+      waitpid(worker.pid, &status, 0);
+      if (WIFEXITED(status) && WEXITSTATUS(status) == 0 && !worker.output.empty()) {
+        cout << worker.output << flush;
+      } else {
+        failures++;
+        cout << "{\"instance\": " << Quote(worker.instance) << ", \"error\": \"solve failed\"}" << endl;
+      }
+      workers.erase(workers.begin() + i);
+    }
+  }
+
+  return failures ? 1 : 0;
+}
+
+pid_t Batch::Fork(const function<string()>& job, int& fd) {
+  // a forked worker only has the calling thread: the locks held by the other threads (e.g. the local
+  // search thread pool) would never be released, so nothing may start a thread before the workers
+  if (ProcessThreads() > 1) {
+    cerr << "fork: the process is not single threaded" << endl;
+    return -1;
+  }
+
+  int fds[2];
+  if (pipe(fds) != 0) {
+    perror("pipe");
+    return -1;
+  }
+
+  // the worker inherits the unwritten output of the parent
+  cout.flush();
+
+  pid_t pid = fork();
+  if (pid < 0) {
+    perror("fork");
+    close(fds[0]);
+    close(fds[1]);
+    return -1;
+  }
+  if (pid == 0) {
+    close(fds[0]);
+    RunWorker(fds[1], job);
+  }
+
+  close(fds[1]);
+  fd = fds[0];
+  return pid;
+}
+
+string Batch::Quote(const string& text) {
+  string quoted = "\"";
+  for (char c : text) {
+    if (c == '"' || c == '\\') quoted += '\\';
+    quoted += c;
+  }
+  return quoted + "\"";
+}
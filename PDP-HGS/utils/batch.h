@@ -0,0 +1,61 @@
+/*MIT License
+ *
+Copyright(c) 2022 Toni Pacheco
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <sys/types.h>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+//! Batch of instances solved by a pool of worker processes. The solvers keep their state in static
+//! members and in the std::rand sequence, so each solve runs in its own forked worker: it starts
+//! from the state of the parent, as a separate run would, without the process startup.
+class Batch {
+  public:
+    //! Get the instance files of a batch.
+    //! \param path: directory (its files but the .sol solutions, sorted) or list file (a path per line).
+    //! \return std::vector<std::string>: instance file paths.
+    static std::vector<std::string> Instances(const std::string& path);
+
+    //! Solve the instances, each worker taking the next instance as soon as it is done, and print
+    //! each result as a JSON line when its solve finishes.
+    //! \param instances: instance file paths.
+    //! \param jobs: maximum number of concurrent workers (0 for the number of cores).
+    //! \param solve: solves an instance in a worker and returns its result as a JSON line.
+    //! \return int: 0 if all the solves succeeded, 1 otherwise.
+    static int Run(const std::vector<std::string>& instances, int jobs,
+                   const std::function<std::string(const std::string&)>& solve);
+
+    //! Fork a worker process running a job. The process must be single threaded.
+    //! \param job: run in the worker, returns the line sent to the parent.
+    //! \param fd: receives the read end of the pipe of the line (end of file when the worker is done).
+    //! \return pid_t: worker process id (-1 on failure, or if another thread is running).
+    static pid_t Fork(const std::function<std::string()>& job, int& fd);
+
+    //! Quote a string as a JSON string.
+    static std::string Quote(const std::string& text);
+};
+
+#endif  // BATCH_H
@@ -0,0 +1,80 @@
+#include "checkpoint.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+#define CHECKPOINT_MAGIC std::string("PDPHGS\n")
+
+// version of the snapshot content, to be increased when it changes
+#define CHECKPOINT_FORMAT 2
+
+using namespace std;
+
+Checkpoint::Checkpoint(const string& file, double every)
+    : file(file), every(every), last(chrono::steady_clock::now()), hasPending(false), stop(false) {
+  writer = thread(&Checkpoint::Run, this);
+}
+
+Checkpoint::~Checkpoint() {
+  {
+    lock_guard<std::mutex> lock(mutex);
+    stop = true;
+  }
+  wakeup.notify_one();
+  writer.join();
+}
+
+bool Checkpoint::Due() const {
+  return chrono::steady_clock::now() - last >= every;
+}
+
+void Checkpoint::Write(const Data& data) {
+  last = chrono::steady_clock::now();
+  {
+    lock_guard<std::mutex> lock(mutex);
+    pending = data;
+    hasPending = true;
+  }
+  wakeup.notify_one();
+}
+
+void Checkpoint::Run() {
+  unique_lock<std::mutex> lock(mutex);
+  while (true) {
+    wakeup.wait(lock, [this]() { return hasPending || stop; });
+    if (!hasPending) return;
+
+    Data data = pending;
+    hasPending = false;
+    lock.unlock();
+
+    // a preempted write leaves the previous snapshot in place
+    string temporary = file + ".tmp";
+    ofstream out(temporary, ios::binary | ios::trunc);
+    uint32_t format = CHECKPOINT_FORMAT;
+    out << CHECKPOINT_MAGIC;
+    out.write((const char*)&format, sizeof(format));
+    out << data.Bytes();
+    out.close();
+    if (!out || rename(temporary.c_str(), file.c_str()) != 0)
+      cerr << "Cannot write the checkpoint " << file << endl;
+
+    lock.lock();
+  }
+}
+
+Checkpoint::Data Checkpoint::Read(const string& file) {
+  ifstream in(file, ios::binary);
+  if (!in) throw runtime_error("Cannot read the checkpoint " + file);
+  string content((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+
+  if (content.compare(0, CHECKPOINT_MAGIC.size(), CHECKPOINT_MAGIC) != 0)
+    throw runtime_error(file + " is not a pdphgs checkpoint");
+
+  Data data(content.substr(CHECKPOINT_MAGIC.size()));
+  if (data.Get<uint32_t>() != CHECKPOINT_FORMAT)
+    throw runtime_error(file + " is a checkpoint of another pdphgs version");
+  return data;
+}
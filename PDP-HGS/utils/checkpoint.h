@@ -0,0 +1,144 @@
+/*MIT License
+ *
+Copyright(c) 2022 Toni Pacheco
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdint.h>
+#include <string.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+//! Periodic binary snapshots of a run (--checkpoint). The search thread serializes its state in
+//! memory, and a background thread writes it to the disk, so the search does not wait for the file.
+//! The snapshots use the memory layout of the build, so they resume on the same build.
+class Checkpoint {
+  public:
+    //! Snapshot being built or read.
+    class Data {
+      public:
+        Data() : offset(0) {
+        }
+
+        explicit Data(const std::string& bytes) : bytes(bytes), offset(0) {
+        }
+
+        template <typename T>
+        void Put(const T& value) {
+          bytes.append((const char*)&value, sizeof(T));
+        }
+
+        template <typename T>
+        void PutVector(const std::vector<T>& values) {
+          Put<uint64_t>(values.size());
+          bytes.append((const char*)values.data(), values.size() * sizeof(T));
+        }
+
+        void PutString(const std::string& value) {
+          Put<uint64_t>(value.size());
+          bytes.append(value);
+        }
+
+        //! \throw std::runtime_error: if the snapshot is truncated.
+        template <typename T>
+        T Get() {
+          T value;
+          memcpy(&value, Take(sizeof(T)), sizeof(T));
+          return value;
+        }
+
+        template <typename T>
+        std::vector<T> GetVector() {
+          size_t size = Get<uint64_t>();
+          std::vector<T> values(size);
+          if (size) memcpy(values.data(), Take(size * sizeof(T)), size * sizeof(T));
+          return values;
+        }
+
+        std::string GetString() {
+          size_t size = Get<uint64_t>();
+          return std::string(Take(size), size);
+        }
+
+        const std::string& Bytes() const {
+          return bytes;
+        }
+
+        //! FNV-1a hash of a memory block, chained from a previous hash (fingerprints of a snapshot).
+        static uint64_t Hash(const void* data, size_t size, uint64_t hash = 14695981039346656037ULL) {
+          const unsigned char* block = (const unsigned char*)data;
+          for (size_t i = 0; i < size; i++) hash = (hash ^ block[i]) * 1099511628211ULL;
+          return hash;
+        }
+
+      private:
+        const char* Take(size_t size) {
+          if (offset + size > bytes.size()) throw std::runtime_error("Truncated checkpoint");
+          offset += size;
+          return bytes.data() + offset - size;
+        }
+
+        std::string bytes;
+        size_t offset;
+    };
+
+    //! Checkpoint constructor.
+    //! \param file: snapshot file, replaced at each write.
+    //! \param every: seconds (wall clock) between snapshots.
+    Checkpoint(const std::string& file, double every);
+
+    //! Checkpoint destructor, waits for the last snapshot to be written.
+    ~Checkpoint();
+
+    //! Check if a snapshot is due.
+    bool Due() const;
+
+    //! Hand a snapshot to the writer thread, a newer snapshot replacing one not written yet.
+    void Write(const Data& data);
+
+    //! Read a snapshot file.
+    //! \throw std::runtime_error: if the file is not a snapshot, or one of another format version.
+    static Data Read(const std::string& file);
+
+  private:
+    //! Writer thread.
+    void Run();
+
+    const std::string file;
+    const std::chrono::duration<double> every;
+    std::chrono::steady_clock::time_point last;
+
+    std::thread writer;
+    std::mutex mutex;
+    std::condition_variable wakeup;
+    Data pending;
+    bool hasPending;
+    bool stop;
+};
+
+#endif  // CHECKPOINT_H
@@ -0,0 +1,48 @@
+#include "profiler.h"
+
+#include <stdio.h>
+
+bool Profile::enabled = false;
+
+Profile::Profile() {
+  calls = improving = 0;
+  gain = 0;
+  time = 0;
+  for (int b = 0; b < PROFILE_BUCKETS; b++) histogram[b] = 0;
+}
+
+void Profile::Add(int64_t ns, double gain) {
+  int bucket = 0;
+  while (bucket < PROFILE_BUCKETS - 1 && (ns >> bucket) > 0) bucket++;
+
+  calls++;
+  time += ns;
+  histogram[bucket]++;
+
+  if (gain > 0) {
+    improving++;
+    this->gain += gain;
+  }
+}
+
+std::string Profile::Json() const {
+  char buff[100];
+  sprintf(buff, "{\"calls\": %zu, \"improving\": %zu, \"gain\": %.2lf, \"mean_gain\": %.4lf, ", calls, improving,
+          gain, improving ? gain / improving : 0.0);
+  std::string s = buff;
+
+  sprintf(buff, "\"time_ms\": %.3lf, \"mean_us\": %.3lf, \"histogram_ns\": {", time / 1e6,
+          calls ? time / 1e3 / calls : 0.0);
+  s += buff;
+
+  // buckets are keyed by their upper bound
+  bool first = true;
+  for (int b = 0; b < PROFILE_BUCKETS; b++) {
+    if (histogram[b] == 0) continue;
+    sprintf(buff, "%s\"%lld\": %zu", first ? "" : ", ", 1LL << b, histogram[b]);
+    s += buff;
+    first = false;
+  }
+
+  return s + "}}";
+}
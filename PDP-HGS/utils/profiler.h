@@ -0,0 +1,81 @@
+/*MIT License
+ *
+Copyright(c) 2022 Toni Pacheco
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdint.h>
+
+#include <chrono>
+#include <string>
+
+#define PROFILE_BUCKETS 40
+
+//! Counters of a profiled section: calls, improving calls, gain and a latency histogram with
+//! power of two buckets in nanoseconds. Nothing is measured unless --profile is set.
+class Profile {
+  public:
+    //! Profile constructor.
+    Profile();
+
+    //! Start measuring a call.
+    //! \return int64_t: timestamp in nanoseconds (0 when profiling is disabled).
+    static int64_t Start() {
+      return enabled ? Now() : 0;
+    }
+
+    //! Record a call started by Start().
+    //! \param start: timestamp returned by Start().
+    //! \param gain: cost decrease brought by the call, the call is improving if it is positive.
+    void Stop(int64_t start, double gain = 0) {
+      if (enabled) Add(Now() - start, gain);
+    }
+
+    //! Record a call.
+    //! \param ns: latency of the call in nanoseconds.
+    //! \param gain: cost decrease brought by the call.
+    void Add(int64_t ns, double gain);
+
+    //! Get the counters as a JSON object.
+    std::string Json() const;
+
+    //! Monotonic timestamp in nanoseconds.
+    static int64_t Now() {
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                 std::chrono::steady_clock::now().time_since_epoch())
+          .count();
+    }
+
+    //! Flag of profiling mode.
+    static bool enabled;
+
+  private:
+    size_t calls;
+    size_t improving;
+    double gain;
+    int64_t time;
+
+    //! histogram[b] counts the calls lasting less than 2^b ns (and at least 2^(b-1) ns).
+    size_t histogram[PROFILE_BUCKETS];
+};
+
+#endif  // PROFILER_H
@@ -1,5 +1,11 @@
 #include "random.h"
 
+#include <stdlib.h>
+#include <string.h>
+
+// std::rand uses the default random() state of glibc: 128 bytes, the first word holding its position
+#define RANDOM_STATE_SIZE 128
+
 int Random::RandomInt() {
   return std::rand();
 }
@@ -15,3 +21,26 @@ double Random::RandomReal() {
 double Random::RandomReal(double a, double b) {
   return a + RandomReal() * (b - a);
 }
+
+std::string Random::State() {
+#ifdef __GLIBC__
+  char scratch[RANDOM_STATE_SIZE];
+  char* state = initstate(1, scratch, RANDOM_STATE_SIZE);
+  std::string bytes(state, RANDOM_STATE_SIZE);
+  setstate(state);
+  return bytes;
+#else
+  return std::string();
+#endif
+}
+
+void Random::SetState(const std::string& bytes) {
+#ifdef __GLIBC__
+  if (bytes.size() != RANDOM_STATE_SIZE) return;
+
+  char scratch[RANDOM_STATE_SIZE];
+  char* state = initstate(1, scratch, RANDOM_STATE_SIZE);
+  memcpy(state, bytes.data(), RANDOM_STATE_SIZE);
+  setstate(state);
+#endif
+}
@@ -26,6 +26,7 @@ SOFTWARE.*/
 #include <boost/random/mersenne_twister.hpp>
 #include <boost/random/uniform_int_distribution.hpp>
 #include <boost/random/uniform_real_distribution.hpp>
+#include <string>
 
 class Random {
   public:
@@ -44,6 +45,13 @@ class Random {
     //! Generates a random double on [a, b] interval
     static double RandomReal(double a, double b);
 
+    //! Get the state of the generator, to continue the same sequence later (checkpoint).
+    //! \return std::string: state bytes (empty if the C library does not expose its state).
+    static std::string State();
+
+    //! Restore a state got from State.
+    static void SetState(const std::string& state);
+
     template <typename _RAIter>
     static void shuffle(_RAIter _begin, _RAIter _end) {
       std::random_shuffle(_begin, _end);
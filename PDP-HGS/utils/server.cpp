@@ -0,0 +1,255 @@
+#include "server.h"
+
+#include <fcntl.h>
+#include <limits.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <map>
+#include <thread>
+#include <vector>
+
+#include "batch.h"
+
+using namespace std;
+
+namespace {
+
+//! Client connection (the standard input and output, or an accepted socket).
+struct Connection {
+    int in;
+    int out;
+
+    //! received bytes not yet ending a request line.
+    std::string buffer;
+
+    //! response lines not yet sent.
+    std::string output;
+
+    //! requests queued or running.
+    int pending;
+
+    //! end of file of the requests: closed once the pending requests are answered.
+    bool closing;
+};
+
+struct Request {
+    int connection;
+    std::string line;
+
+    //! output of the preparation job of the request.
+    std::string prepared;
+};
+
+//! Worker process running the job of a request.
+struct Worker {
+    pid_t pid;
+    int fd;
+    Request request;
+
+    //! the job prepares the request, which is queued again once it's done.
+    bool preparing;
+
+    //! response if the worker fails.
+    std::string fallback;
+    std::string output;
+};
+
+//! Send the buffered responses of a connection, as much as it takes without waiting.
+void Flush(Connection& connection) {
+  // the standard output may be blocking, but after a poll a pipe takes PIPE_BUF bytes without waiting
+  size_t size = connection.output.size();
+  if (!(fcntl(connection.out, F_GETFL) & O_NONBLOCK)) size = min(size, (size_t)PIPE_BUF);
+
+  ssize_t n = write(connection.out, connection.output.data(), size);
+  if (n > 0) {
+    connection.output.erase(0, n);
+  } else if (n < 0 && errno != EINTR && errno != EAGAIN && errno != EWOULDBLOCK) {
+    // the client left
+    connection.output.clear();
+    connection.closing = true;
+  }
+}
+
+//! Open a listening Unix socket.
+//! \return int: socket, or -1 on failure.
+int Listen(const string& path) {
+  sockaddr_un address;
+  if (path.size() >= sizeof(address.sun_path)) {
+    cerr << "Socket path too long: " << path << endl;
+    return -1;
+  }
+
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) {
+    perror("socket");
+    return -1;
+  }
+
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+  unlink(path.c_str());
+  if (bind(fd, (sockaddr*)&address, sizeof(address)) != 0 || listen(fd, SOMAXCONN) != 0) {
+    perror("bind");
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+}  // namespace
+
+int Server::Serve(const string& address, int jobs, const Handler& handler) {
+  if (jobs <= 0) jobs = max(1, (int)thread::hardware_concurrency());
+
+  // a client leaving before its response must not stop the server
+  signal(SIGPIPE, SIG_IGN);
+
+  int listener = -1;
+  map<int, Connection> connections;
+  int nextConnection = 0;
+  if (address == "-") {
+    connections[nextConnection++] = {STDIN_FILENO, STDOUT_FILENO, "", "", 0, false};
+  } else {
+    listener = Listen(address);
+    if (listener < 0) return 1;
+  }
+
+  deque<Request> queue;
+  vector<Worker> workers;
+  char buffer[65536];
+
+  while (listener >= 0 || !connections.empty()) {
+    // start the queued requests, in their arrival order
+    while ((int)workers.size() < jobs && !queue.empty()) {
+      Request request = queue.front();
+      queue.pop_front();
+
+      string response;
+      bool preparing = false;
+      Job job = handler(request.line, request.prepared, response, preparing);
+      request.prepared.clear();
+      int fd;
+      pid_t pid = job ? Batch::Fork(job, fd) : -1;
+      if (pid >= 0) {
+        workers.push_back({pid, fd, request, preparing, response, ""});
+        continue;
+      }
+
+      Connection& connection = connections[request.connection];
+      connection.output += response + "\n";
+      connection.pending--;
+    }
+
+    // close the connections whose requests are all answered
+    for (map<int, Connection>::iterator it = connections.begin(); it != connections.end();) {
+      if (it->second.closing && it->second.pending == 0 && it->second.output.empty()) {
+        if (it->second.in != STDIN_FILENO) close(it->second.in);
+        it = connections.erase(it);
+      } else {
+        it++;
+      }
+    }
+    if (listener < 0 && connections.empty()) break;
+
+    // the requests are read from in, the responses written to out (the same socket, or two descriptors)
+    vector<pollfd> polls;
+    vector<int> polled;
+    for (const Worker& worker : workers) polls.push_back({worker.fd, POLLIN, 0});
+    for (const pair<const int, Connection>& connection : connections) {
+      const Connection& client = connection.second;
+      short in = client.closing ? 0 : POLLIN;
+      short out = client.output.empty() ? 0 : POLLOUT;
+      if (client.in != client.out && in && out) {
+        polls.push_back({client.out, out, 0});
+        polled.push_back(connection.first);
+        out = 0;
+      }
+      if (!in && !out) continue;
+      polls.push_back({in ? client.in : client.out, (short)(in | out), 0});
+      polled.push_back(connection.first);
+    }
+    if (listener >= 0) polls.push_back({listener, POLLIN, 0});
+    if (poll(polls.data(), polls.size(), -1) < 0) continue;
+    size_t nWorkers = workers.size();
+
+    // responses
+    for (int i = (int)workers.size() - 1; i >= 0; i--) {
+      if (!polls[i].revents) continue;
+
+      Worker& worker = workers[i];
+      ssize_t n = read(worker.fd, buffer, sizeof(buffer));
+      if (n > 0) {
+        worker.output.append(buffer, n);
+        continue;
+      }
+      if (n < 0 && errno == EINTR) continue;
+
+      close(worker.fd);
+      int status;
+      waitpid(worker.pid, &status, 0);
+      bool succeeded = WIFEXITED(status) && WEXITSTATUS(status) == 0 && !worker.output.empty();
+
+      if (succeeded && worker.preparing) {
+        // the prepared request is started next, its turn having come when it was prepared
+        worker.output.pop_back();
+        worker.request.prepared.swap(worker.output);
+        queue.push_front(worker.request);
+      } else {
+        Connection& connection = connections[worker.request.connection];
+        connection.output += succeeded ? worker.output : worker.fallback + "\n";
+        connection.pending--;
+      }
+      workers.erase(workers.begin() + i);
+    }
+
+    // sent responses and requests
+    for (size_t i = 0; i < polled.size(); i++) {
+      const pollfd& polling = polls[nWorkers + i];
+      if (!polling.revents) continue;
+
+      Connection& connection = connections[polled[i]];
+      if (polling.events & POLLOUT) Flush(connection);
+      if (!(polling.events & POLLIN) || !(polling.revents & (POLLIN | POLLHUP | POLLERR))) continue;
+
+      ssize_t n = read(connection.in, buffer, sizeof(buffer));
+      if (n < 0 && (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK)) continue;
+      if (n <= 0) {
+        connection.closing = true;
+        continue;
+      }
+
+      connection.buffer.append(buffer, n);
+      size_t end;
+      while ((end = connection.buffer.find('\n')) != string::npos) {
+        string line = connection.buffer.substr(0, end);
+        connection.buffer.erase(0, end + 1);
+        if (line.find_first_not_of(" \t\r") == string::npos) continue;
+
+        queue.push_back({polled[i], line, ""});
+        connection.pending++;
+      }
+    }
+
+    // new clients, never waited for
+    if (listener >= 0 && polls.back().revents) {
+      int fd = accept(listener, nullptr, nullptr);
+      if (fd >= 0) {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        connections[nextConnection++] = {fd, fd, "", "", 0, false};
+      }
+    }
+  }
+
+  return 0;
+}
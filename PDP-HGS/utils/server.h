@@ -0,0 +1,59 @@
+/*MIT License
+ *
+Copyright(c) 2022 Toni Pacheco
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <functional>
+#include <string>
+
+//! Line-delimited request server over a local socket or the standard input and output. The requests
+//! of all the clients are queued and run in order by at most a given number of forked workers, each
+//! response line being sent back to the client of its request when its worker is done. The server
+//! process never waits for a client: the sockets are non-blocking and the responses are buffered.
+class Server {
+  public:
+    //! Job run in a forked worker, returns the response line.
+    typedef std::function<std::string()> Job;
+
+    //! Request handler, called in the server process when a worker is free. It must not take long, the
+    //! other clients waiting for it: a request needing a long preparation (e.g. loading an instance) is
+    //! given a preparation job, whose output is handed back to the handler with the request.
+    //! \param request: request line.
+    //! \param prepared: output of the preparation job of the request (empty if it had none).
+    //! \param response: response sent without a worker if the returned job is empty (e.g. an error),
+    //!                  or if the worker fails.
+    //! \param preparing: set if the returned job is a preparation job.
+    //! \return Job: job of the request.
+    typedef std::function<Job(const std::string& request, const std::string& prepared, std::string& response,
+                              bool& preparing)>
+        Handler;
+
+    //! Serve requests until the standard input is closed (or forever on a socket).
+    //! \param address: Unix socket path, or "-" for the standard input and output.
+    //! \param jobs: maximum number of concurrent workers (0 for the number of cores).
+    //! \param handler: request handler.
+    //! \return int: 0 on a clean shutdown, 1 if the server cannot start.
+    static int Serve(const std::string& address, int jobs, const Handler& handler);
+};
+
+#endif  // SERVER_H
@@ -0,0 +1,43 @@
+#include "solutionfile.h"
+
+#include <boost/property_tree/json_parser.hpp>
+#include <cctype>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+using namespace std;
+
+vector<int> SolutionFile::Read(const string& path) {
+  ifstream in(path);
+  if (!in) throw runtime_error("Cannot read the solution file " + path);
+  string content((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+
+  vector<int> visits;
+  size_t start = content.find_first_not_of(" \t\r\n");
+  if (start != string::npos && content[start] == '{') {
+    boost::property_tree::ptree tree;
+    istringstream json(content);
+    try {
+      boost::property_tree::read_json(json, tree);
+    } catch (const boost::property_tree::json_parser_error& e) {
+      throw runtime_error("Invalid solution file " + path + ": " + e.what());
+    }
+
+    boost::optional<boost::property_tree::ptree&> route = tree.get_child_optional("route");
+    if (!route) route = tree.get_child_optional("solution");
+    if (!route) throw runtime_error("No route nor solution in " + path);
+    for (const boost::property_tree::ptree::value_type& visit : *route)
+      visits.push_back(visit.second.get_value<int>());
+    return visits;
+  }
+
+  // plain list: the numbers separated by anything else
+  for (char& c : content) {
+    if (!isdigit((unsigned char)c) && c != '-') c = ' ';
+  }
+  istringstream list(content);
+  int visit;
+  while (list >> visit) visits.push_back(visit);
+  return visits;
+}
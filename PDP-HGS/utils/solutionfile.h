@@ -0,0 +1,40 @@
+/*MIT License
+ *
+Copyright(c) 2022 Toni Pacheco
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+#ifndef SOLUTIONFILE_H
+#define SOLUTIONFILE_H
+
+#include <string>
+#include <vector>
+
+//! Solution files given to warm start the solvers.
+class SolutionFile {
+  public:
+    //! Read the visit order of a solution file: a JSON object with a "route" (.sol references) or a
+    //! "solution" (pdphgs and pdprr output), or a plain list of node indices.
+    //! \param path: solution file path.
+    //! \return std::vector<int>: node indices in visit order.
+    //! \throw std::runtime_error: if the file cannot be read.
+    static std::vector<int> Read(const std::string& path);
+};
+
+#endif  // SOLUTIONFILE_H
@@ -0,0 +1,112 @@
+#include "threadpool.h"
+
+#include <time.h>
+
+#include <algorithm>
+
+#include "utils/application.h"
+
+namespace {
+thread_local bool inTask = false;
+}
+
+ThreadPool::ThreadPool(int nThreads) {
+  task = nullptr;
+  generation = 0;
+  pending = 0;
+  running = false;
+  stop = false;
+
+  for (int t = 1; t < nThreads; t++) {
+    workers.push_back(std::thread(&ThreadPool::Work, this, t));
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stop = true;
+  }
+  wakeup.notify_all();
+
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+}
+
+bool ThreadPool::Run(const std::function<void(int)>& task) {
+  if (inTask) return false;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (running) return false;
+
+    running = true;
+    this->task = &task;
+    pending = (int)workers.size();
+    generation++;
+  }
+  wakeup.notify_all();
+
+  inTask = true;
+  task(0);
+  inTask = false;
+
+  std::unique_lock<std::mutex> lock(mutex);
+  finished.wait(lock, [this] { return pending == 0; });
+  this->task = nullptr;
+  running = false;
+
+  return true;
+}
+
+void ThreadPool::Work(int id) {
+  size_t seen = 0;
+  inTask = true;
+
+  while (true) {
+    const std::function<void(int)>* current;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      wakeup.wait(lock, [this, seen] { return stop || generation != seen; });
+      if (stop) return;
+
+      seen = generation;
+      current = task;
+    }
+
+    (*current)(id);
+
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      pending--;
+    }
+    finished.notify_one();
+  }
+}
+
+bool ThreadPool::InTask() {
+  return inTask;
+}
+
+double ThreadPool::ThreadCpuTime() {
+  timespec now;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+  return 1000.0 * now.tv_sec + now.tv_nsec / 1e6;
+}
+
+ThreadPool* ThreadPool::Shared() {
+  static std::mutex mutex;
+  static ThreadPool* pool = nullptr;
+
+  std::lock_guard<std::mutex> lock(mutex);
+
+  // the pool follows --threads between solves, never under a running task
+  int size = (pool != nullptr) ? pool->Size() : 1;
+  if (!inTask && size != std::max(1, Application::threads)) {
+    delete pool;
+    pool = (Application::threads > 1) ? new ThreadPool(Application::threads) : nullptr;
+  }
+
+  return pool;
+}
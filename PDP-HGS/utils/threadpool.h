@@ -0,0 +1,78 @@
+/*MIT License
+ *
+Copyright(c) 2022 Toni Pacheco
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool {
+  public:
+    //! ThreadPool constructor.
+    //! \param nThreads: number of threads running tasks, including the calling thread.
+    explicit ThreadPool(int nThreads);
+
+    //! ThreadPool destructor.
+    ~ThreadPool();
+
+    //! Number of threads taking part in Run (calling thread included).
+    int Size() const {
+      return (int)workers.size() + 1;
+    }
+
+    //! Run task(t) for every t in [0, Size()) concurrently, the calling thread runs t = 0.
+    //! \param task: task to run, receives the thread index.
+    //! \return bool: false if the pool is busy or called from one of its tasks (nothing runs).
+    bool Run(const std::function<void(int)>& task);
+
+    //! Check if the current thread is running a pool task.
+    static bool InTask();
+
+    //! CPU time consumed by the calling thread.
+    //! \return double: time in milliseconds.
+    static double ThreadCpuTime();
+
+    //! Pool shared by the local search, sized by --threads. It is rebuilt when --threads changes,
+    //! unless called from a pool task, and started on first use only.
+    //! \return ThreadPool*: nullptr when running single threaded.
+    static ThreadPool* Shared();
+
+  private:
+    void Work(int id);
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wakeup;
+    std::condition_variable finished;
+
+    const std::function<void(int)>* task;
+    size_t generation;
+    int pending;
+    bool running;
+    bool stop;
+};
+
+#endif  // THREADPOOL_H
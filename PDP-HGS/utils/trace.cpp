@@ -0,0 +1,96 @@
+#include "trace.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <mutex>
+#include <set>
+#include <vector>
+
+bool Trace::enabled = false;
+
+namespace {
+
+struct TraceEvent {
+    const char* name;
+    int64_t start;
+    int64_t end;
+};
+
+//! Ring buffer written by a single thread.
+struct TraceBuffer {
+    TraceEvent* events;
+    size_t count;
+    int thread;
+};
+
+std::string traceFile;
+int64_t traceStart = 0;
+
+// the mutex only guards the registration of the buffers and the interned names
+std::mutex traceMutex;
+std::vector<TraceBuffer*> traceBuffers;
+std::set<std::string> traceNames;
+
+thread_local TraceBuffer* traceBuffer = nullptr;
+
+void FlushAtExit() {
+  Trace::Flush();
+}
+
+}  // namespace
+
+void Trace::Open(const std::string& file) {
+  traceFile = file;
+  traceStart = Now();
+  enabled = true;
+  atexit(FlushAtExit);
+}
+
+const char* Trace::Intern(const std::string& name) {
+  std::lock_guard<std::mutex> lock(traceMutex);
+  return traceNames.insert(name).first->c_str();
+}
+
+void Trace::Record(const char* name, int64_t start, int64_t end) {
+  if (traceBuffer == nullptr) {
+    std::lock_guard<std::mutex> lock(traceMutex);
+    traceBuffer = new TraceBuffer;
+    traceBuffer->events = new TraceEvent[TRACE_BUFFER_EVENTS];
+    traceBuffer->count = 0;
+    traceBuffer->thread = (int)traceBuffers.size();
+    traceBuffers.push_back(traceBuffer);
+  }
+
+  TraceEvent& event = traceBuffer->events[traceBuffer->count++ % TRACE_BUFFER_EVENTS];
+  event.name = name;
+  event.start = start;
+  event.end = end;
+}
+
+void Trace::Flush() {
+  if (!enabled) return;
+  enabled = false;
+
+  FILE* file = fopen(traceFile.c_str(), "w");
+  if (file == nullptr) {
+    fprintf(stderr, "Cannot write the trace file %s\n", traceFile.c_str());
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(traceMutex);
+  fprintf(file, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [");
+  bool first = true;
+  for (TraceBuffer* buffer : traceBuffers) {
+    size_t begin = buffer->count > TRACE_BUFFER_EVENTS ? buffer->count - TRACE_BUFFER_EVENTS : 0;
+    for (size_t i = begin; i < buffer->count; i++) {
+      const TraceEvent& event = buffer->events[i % TRACE_BUFFER_EVENTS];
+      fprintf(file, "%s\n{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %d, \"ts\": %.3lf, \"dur\": %.3lf}",
+              first ? "" : ",", event.name, buffer->thread, (event.start - traceStart) / 1e3,
+              (event.end - event.start) / 1e3);
+      first = false;
+    }
+  }
+  fprintf(file, "\n]}\n");
+  fclose(file);
+}
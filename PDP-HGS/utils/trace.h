@@ -0,0 +1,93 @@
+/*MIT License
+ *
+Copyright(c) 2022 Toni Pacheco
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+
+#include <chrono>
+#include <string>
+
+//! Events kept by each thread, the oldest ones being overwritten once the buffer is full.
+#define TRACE_BUFFER_EVENTS (1 << 20)
+
+//! Timeline of the run in the Chrome trace event format (chrome://tracing or Perfetto), written
+//! with --trace. Each thread records its spans into its own ring buffer without locking, and the
+//! buffers are written to the file at exit.
+class Trace {
+  public:
+    //! Enable tracing, the trace being written to file at exit.
+    //! \param file: path of the JSON trace file.
+    static void Open(const std::string& file);
+
+    //! Write the recorded spans to the trace file (called at exit).
+    static void Flush();
+
+    //! Start a span.
+    //! \return int64_t: timestamp in nanoseconds (0 when tracing is disabled).
+    static int64_t Start() {
+      return enabled ? Now() : 0;
+    }
+
+    //! Record a span started by Start().
+    //! \param name: span name, it must outlive the trace (a literal or an Intern() result).
+    //! \param start: timestamp returned by Start().
+    static void Stop(const char* name, int64_t start) {
+      if (enabled) Record(name, start, Now());
+    }
+
+    //! Get a name usable by the trace for a string built at run time.
+    static const char* Intern(const std::string& name);
+
+    //! Monotonic timestamp in nanoseconds.
+    static int64_t Now() {
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                 std::chrono::steady_clock::now().time_since_epoch())
+          .count();
+    }
+
+    //! Span covering the scope where it is declared.
+    class Span {
+      public:
+        explicit Span(const char* name) : name(name), start(Start()) {
+        }
+        ~Span() {
+          Stop(name, start);
+        }
+
+      private:
+        Span(const Span&) = delete;
+        Span& operator=(const Span&) = delete;
+
+        const char* name;
+        int64_t start;
+    };
+
+    //! Flag of tracing mode.
+    static bool enabled;
+
+  private:
+    static void Record(const char* name, int64_t start, int64_t end);
+};
+
+#endif  // TRACE_H
@@ -0,0 +1,4 @@
+#include "work.h"
+
+uint64_t Work::limit = 0;
+std::atomic<uint64_t> Work::counter(0);
@@ -0,0 +1,79 @@
+/*MIT License
+ *
+Copyright(c) 2022 Toni Pacheco
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+#ifndef WORK_H
+#define WORK_H
+
+#include <stdint.h>
+
+#include <atomic>
+
+//! Deterministic work counter: the kernels add the candidate moves, dynamic programming cells and
+//! graph arcs they evaluate, each of them reading a few distance matrix entries. The count of a
+//! run only depends on its parameters, so --work-limit budgets compare code versions and machines.
+class Work {
+  public:
+    //! Count evaluated units (called once per kernel call, from any thread).
+    static void Add(uint64_t units) {
+      counter.fetch_add(units, std::memory_order_relaxed);
+    }
+
+    //! Restart the count for a new run.
+    static void Reset() {
+      counter.store(0, std::memory_order_relaxed);
+    }
+
+    //! Continue the count of a resumed run.
+    //! \param units: units counted before the run was interrupted.
+    static void Restore(uint64_t units) {
+      counter.store(units, std::memory_order_relaxed);
+    }
+
+    //! Get the units counted since the start of the run.
+    static uint64_t Units() {
+      return counter.load(std::memory_order_relaxed);
+    }
+
+    //! Check if the work budget is spent.
+    static bool Exhausted() {
+      return limit > 0 && Units() >= limit;
+    }
+
+    //! Get the fraction of the work budget spent.
+    static double Ratio() {
+      return limit > 0 ? (double)Units() / limit : 0;
+    }
+
+    //! Get the units counted per second of a run.
+    //! \param seconds: run time.
+    static double PerSecond(double seconds) {
+      return seconds > 0 ? Units() / seconds : 0;
+    }
+
+    //! Work budget in units (0 for unlimited).
+    static uint64_t limit;
+
+  private:
+    static std::atomic<uint64_t> counter;
+};
+
+#endif  // WORK_H
@@ -9,21 +9,31 @@ QMAKE_CXXFLAGS += -std=c++0x
 SOURCES += \
         instance.cpp \
         operators.cpp \
+        main.cpp \
         solver.cpp \
         application.cpp \
-        random.cpp
+        random.cpp \
+        ../PDP-HGS/utils/solutionfile.cpp \
+        ../PDP-HGS/utils/trace.cpp \
+        ../PDP-HGS/utils/work.cpp
 
 HEADERS += \
     instance.h \
     operators.h \
     solver.h \
     application.h \
-    random.h
+    random.h \
+    ../PDP-HGS/utils/solutionfile.h \
+    ../PDP-HGS/utils/trace.h \
+    ../PDP-HGS/utils/work.h
+
+INCLUDEPATH += ../PDP-HGS
 
 LIBS += -lboost_program_options
 LIBS += -lboost_filesystem
 LIBS += -lboost_system
 LIBS += -lboost_regex
+LIBS += -lpthread
 
 CONFIG(debug, debug|release) {
   #QMAKE_CXXFLAGS += -Og
@@ -2,14 +2,22 @@
 
 #include <time.h>
 
+#include <algorithm>
 #include <boost/algorithm/string.hpp>
 #include <iostream>
 #include <string>
 
+#include "utils/trace.h"
+#include "utils/work.h"
+
 using namespace std;
 
+namespace rr {
+
 time_t Application::startTime;
+std::chrono::steady_clock::time_point Application::wallStartTime;
 int Application::timeLimit;
+double Application::wallLimit;
 bool Application::verbose;
 std::string Application::version = "v1.0.0";
 
@@ -33,6 +41,10 @@ boost::program_options::variables_map Application::initializeVariablesMap(int ar
 
   add_option("fast", "Use the fast reinsertion operator");
 
+  add_option("initial", boost::program_options::value<std::vector<string> >()->composing(),
+             "Solution file (.sol, pdprr output or list of nodes) to start from, repaired if needed. The best "
+             "one is used if given several times.");
+
   add_option("seed", default_param(DEFAULT_SEED), "Sets a random seed.");
 
   add_option("p-accept", default_param(DEFAULT_P), "p parameter to accept a request as worst.");
@@ -43,6 +55,14 @@ boost::program_options::variables_map Application::initializeVariablesMap(int ar
 
   add_option("time-limit", boost::program_options::value<int>(), "Set maximum execution time in seconds.");
 
+  add_option("wall-limit", boost::program_options::value<double>(),
+             "Set maximum wall-clock time in seconds (--time-limit counts the CPU time).");
+
+  add_option("work-limit", boost::program_options::value<uint64_t>(),
+             "Set maximum work in deterministic units (evaluated insertions and removals).");
+
+  add_option("trace", boost::program_options::value<string>(), "Write a Chrome trace of the run to the given file.");
+
   boost::program_options::store(
       boost::program_options::command_line_parser(argc, (const char* const*)argv).options(description).run(),
       variablesMap);
@@ -60,6 +80,7 @@ boost::program_options::variables_map Application::initializeVariablesMap(int ar
   }
 
   startTime = clock();
+  wallStartTime = std::chrono::steady_clock::now();
 
   timeLimit = INT_MAX;
   if (variablesMap.count("time-limit") > 0) {
@@ -67,7 +88,21 @@ boost::program_options::variables_map Application::initializeVariablesMap(int ar
     Application::SetTimeLimit(timeLimit);
   }
 
+  wallLimit = 0;
+  if (variablesMap.count("wall-limit") > 0) {
+    wallLimit = std::max(0.0, variablesMap["wall-limit"].as<double>());
+  }
+
+  Work::limit = 0;
+  if (variablesMap.count("work-limit") > 0) {
+    Work::limit = variablesMap["work-limit"].as<uint64_t>();
+  }
+
   Application::verbose = variablesMap["verbose"].as<bool>();
+
+  if (variablesMap.count("trace") > 0) {
+    Trace::Open(variablesMap["trace"].as<string>());
+  }
   return variablesMap;
 }
 
@@ -87,11 +122,25 @@ double Application::Ellapsed() {
   return static_cast<double>(clock() - startTime) / CLOCKS_PER_SEC;
 }
 
+double Application::WallEllapsed() {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStartTime).count();
+}
+
 double Application::EllapsedRatio() {
-  return Ellapsed() / timeLimit;
+  // the annealing cools down with the budget closest to its end
+  double ratio = Ellapsed() / timeLimit;
+  if (wallLimit > 0) ratio = std::max(ratio, WallEllapsed() / wallLimit);
+  return ratio;
+}
+
+bool Application::UsingWorkLimit() {
+  return Work::limit > 0;
 }
 
 bool Application::Timeout() {
   double ellapsed = Ellapsed();
-  return (ellapsed > MAX_ALLOWED_RUNTIME) || (ellapsed > timeLimit);
+  return (ellapsed > MAX_ALLOWED_RUNTIME) || (ellapsed > timeLimit) ||
+         (wallLimit > 0 && WallEllapsed() > wallLimit) || Work::Exhausted();
 }
+
+}  // namespace rr
@@ -26,6 +26,7 @@ SOFTWARE.*/
 #include <limits.h>
 
 #include <boost/program_options.hpp>
+#include <chrono>
 
 #define DEFAULT_SEED 0
 #define DEFAULT_P 3.0
@@ -35,16 +36,21 @@ SOFTWARE.*/
 // Max allowed runtime set to 5 hours.
 #define MAX_ALLOWED_RUNTIME 18000
 
+namespace rr {
+
 class Application {
   public:
     static boost::program_options::variables_map initializeVariablesMap(int argc, char *argv[]);
 
     static bool UsingTimeLimit() {
-      return timeLimit != INT_MAX;
+      return timeLimit != INT_MAX || wallLimit > 0;
     }
 
+    static bool UsingWorkLimit();
+
     static double EllapsedRatio();
     static double Ellapsed();
+    static double WallEllapsed();
     static std::string Version();
     static bool IsVerbose();
     static bool Timeout();
@@ -53,8 +59,14 @@ class Application {
   private:
     static std::string version;
     static time_t startTime;
+    static std::chrono::steady_clock::time_point wallStartTime;
     static int timeLimit;
+
+    //! Wall-clock time limit in seconds (0 for none).
+    static double wallLimit;
     static bool verbose;
 };
 
+}  // namespace rr
+
 #endif  // APPLICATION_H
@@ -12,6 +12,8 @@
 
 using namespace std;
 
+namespace rr {
+
 bool Solution::operator<(const Solution& sol) {
   return cost < sol.cost;
 }
@@ -91,6 +93,19 @@ Instance::Instance(const string instanceFilePath) {
   CreateDistanceMatrix();
 }
 
+Instance::Instance(const NodeList& nodes, const std::vector<std::vector<double> >& distances) : nodes(nodes) {
+  if (distances.empty()) {
+    CreateDistanceMatrix();
+    return;
+  }
+
+  this->distances = new double*[nodes.size()];
+  for (size_t i = 0; i < nodes.size(); i++) {
+    this->distances[i] = new double[nodes.size()];
+    for (size_t j = 0; j < nodes.size(); j++) this->distances[i][j] = (i == j) ? 0.0 : distances[i][j];
+  }
+}
+
 void Instance::CreateDistanceMatrix() {
   size_t numberOfNodes = nodes.size();
   distances = new double*[numberOfNodes];
@@ -133,3 +148,5 @@ Instance::~Instance() {
   }
   nodes.clear();
 }
+
+}  // namespace rr
@@ -26,6 +26,8 @@ SOFTWARE.*/
 #include <string>
 #include <vector>
 
+namespace rr {
+
 class Solution {
   public:
     Solution();
@@ -49,6 +51,11 @@ class Instance {
     typedef std::vector<const Node*> NodeList;
 
     Instance(const std::string instanceFilePath);
+
+    //! Build an instance in memory.
+    //! \param nodes: instance nodes (the instance takes their ownership), node 0 being the depot.
+    //! \param distances: distance matrix, or empty for the rounded Euclidean distances of the nodes.
+    Instance(const NodeList& nodes, const std::vector<std::vector<double> >& distances);
     virtual ~Instance();
 
     Instance::NodeList Pickups() const;
@@ -62,4 +69,6 @@ class Instance {
     double** distances;
 };
 
+}  // namespace rr
+
 #endif  // INSTANCE_H
@@ -0,0 +1,54 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "application.h"
+#include "solver.h"
+#include "utils/solutionfile.h"
+
+using namespace rr;
+using namespace std;
+
+/* running parameters example:
+--instance=instances/RBO00/Class1/U159C.PDT
+--fast
+--seed=123456
+--it=50000
+*/
+
+int main(int argc, char* argv[]) {
+  boost::program_options::variables_map variablesMap = Application::initializeVariablesMap(argc, argv);
+
+  uint seed = (uint)variablesMap["seed"].as<int>();
+  std::srand(seed);
+
+  if (variablesMap["instance"].empty())  // solve only one instance specified by
+                                         // the --instance cmdline argument
+  {
+    cout << "No input instance. Use --help for more information" << endl;
+    exit(1);
+  }
+
+  // Create solver
+  Solver solver(variablesMap);
+
+  // warm start
+  if (variablesMap.count("initial")) {
+    for (const string& file : variablesMap["initial"].as<vector<string> >()) {
+      try {
+        solver.initial.push_back(SolutionFile::Read(file));
+      } catch (const std::exception& e) {
+        cout << e.what() << endl;
+        exit(1);
+      }
+    }
+  }
+
+  // Run
+  solver.Solve();
+
+  // Print
+  solver.PrintStats();
+
+  return 0;
+}
@@ -6,6 +6,9 @@
 #include <set>
 
 #include "random.h"
+#include "utils/work.h"
+
+namespace rr {
 
 Operators::Operators() {
 }
@@ -21,6 +24,7 @@ double Operators::RemoveRequest(const Instance& instance, std::vector<int>& visi
     else if (visits[i] == deliveryIdx)
       deliveryPos = i;
   }
+  Work::Add(visits.size());
 
   // rm delivery
   cost += instance.distances[visits[deliveryPos - 1]][visits[deliveryPos + 1]] -
@@ -48,6 +52,7 @@ double Operators::EvaluateRemoveRequest(const Instance& instance, std::vector<in
     else if (visits[i] == deliveryIdx)
       deliveryPos = i;
   }
+  Work::Add(visits.size());
 
   if (deliveryPos - pickupPos == 1) {
     cost = instance.distances[visits[pickupPos - 1]][visits[deliveryPos + 1]] -
@@ -121,6 +126,7 @@ double Operators::EvaluateBestInsertionFast(const Instance& instance, std::vecto
       insertPosition[1] = p;
     }
   }
+  Work::Add(2 * visits.size());
 
   return bestCost;
 }
@@ -158,6 +164,7 @@ double Operators::EvaluateBestInsertion(const Instance& instance, std::vector<in
       insertPosition[1] = p;
     }
   }
+  Work::Add((uint64_t)(visits.size() - 2) * (visits.size() - 1) / 2 + visits.size());
 
   return bestCost;
 }
@@ -240,3 +247,5 @@ Instance::NodeList Operators::BlockRemoval(const Instance& instance, Solution& s
 
   return removedRequests;
 }
+
+}  // namespace rr
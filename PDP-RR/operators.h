@@ -25,6 +25,8 @@ SOFTWARE.*/
 
 #include "instance.h"
 
+namespace rr {
+
 class Operators {
   public:
     Operators();
@@ -87,4 +89,6 @@ class Operators {
     static Instance::NodeList BlockRemoval(const Instance& instance, Solution& solution, int q, double p);
 };
 
+}  // namespace rr
+
 #endif  // OPERATORS_H
@@ -1,5 +1,7 @@
 #include "random.h"
 
+namespace rr {
+
 int Random::RandomInt() { return std::rand(); }
 
 int Random::RandomInt(int a, int b) { return a + RandomReal() * (b - a); }
@@ -11,3 +13,5 @@ double Random::RandomReal() {
 double Random::RandomReal(double a, double b) {
   return a + RandomReal() * (b - a);
 }
+
+}  // namespace rr
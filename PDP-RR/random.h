@@ -27,6 +27,8 @@ SOFTWARE.*/
 #include <boost/random/uniform_int_distribution.hpp>
 #include <boost/random/uniform_real_distribution.hpp>
 
+namespace rr {
+
 class Random {
   public:
     /*!
@@ -55,4 +57,6 @@ class Random {
     }
 };
 
+}  // namespace rr
+
 #endif
@@ -8,11 +8,25 @@
 #include "application.h"
 #include "operators.h"
 #include "random.h"
+#include "utils/trace.h"
+#include "utils/work.h"
 
 using namespace std;
 
+namespace rr {
+
 Solver::Solver(boost::program_options::variables_map& variablesMap)
     : instance(variablesMap["instance"].as<string>()) {
+  LoadParameters(variablesMap);
+}
+
+Solver::Solver(boost::program_options::variables_map& variablesMap, const Instance::NodeList& nodes,
+               const std::vector<std::vector<double> >& distances)
+    : instance(nodes, distances) {
+  LoadParameters(variablesMap);
+}
+
+void Solver::LoadParameters(boost::program_options::variables_map& variablesMap) {
   int n = instance.nodes.size() / 2;
   qMin = std::min(30, int(0.20 * n));
   qMax = std::min(50, int(0.55 * n));
@@ -106,19 +120,75 @@ void ReinsertRequests(const Instance& instance, Solution& sol, Instance::NodeLis
   }
 }
 
+/**
+ * @brief Create an initial solution from a given visit order (warm start): the unknown or repeated
+ * nodes and the requests missing a node or visiting their delivery first are removed, then reinserted
+ * at their best position.
+ * @param instance
+ * @param visits
+ * @param useFast
+ * @return
+ */
+Solution RepairSolution(const Instance& instance, const std::vector<int>& visits, bool useFast) {
+  int n = instance.nodes.size();
+  std::vector<int> seen(n, 0);
+  std::vector<int> position(n, -1);
+  for (size_t p = 0; p < visits.size(); p++) {
+    if (visits[p] > 0 && visits[p] < n) {
+      seen[visits[p]]++;
+      position[visits[p]] = p;
+    }
+  }
+
+  std::vector<bool> kept(n, false);
+  Instance::NodeList removedRequests;
+  for (const Instance::Node* pickup : instance.Pickups()) {
+    bool valid = seen[pickup->idx] == 1 && seen[pickup->pair] == 1 &&
+                 position[pickup->idx] < position[pickup->pair];
+    kept[pickup->idx] = kept[pickup->pair] = valid;
+    if (!valid) removedRequests.push_back(pickup);
+  }
+
+  Solution sol;
+  sol.visits.push_back(0);
+  for (int visit : visits) {
+    if (visit > 0 && visit < n && kept[visit]) sol.visits.push_back(visit);
+  }
+  sol.visits.push_back(0);
+  for (size_t i = 0; i < sol.visits.size() - 1; i++)
+    sol.cost += instance.distances[sol.visits[i]][sol.visits[i + 1]];
+
+  ReinsertRequests(instance, sol, removedRequests, useFast);
+  return sol;
+}
+
 void Solver::Solve() {
   iterationCount = 0;
   Solution sol, solPrime;
   Instance::NodeList removedRequests;
 
-  sol = InitialSolution(instance, param_Fast);
+  int64_t traceStart = Trace::Start();
+  if (initial.empty()) {
+    sol = InitialSolution(instance, param_Fast);
+  } else {
+    // warm start from the best of the given solutions
+    sol = RepairSolution(instance, initial[0], param_Fast);
+    for (size_t i = 1; i < initial.size(); i++) {
+      Solution candidate = RepairSolution(instance, initial[i], param_Fast);
+      if (candidate < sol) sol = candidate;
+    }
+  }
+  Trace::Stop("InitialSolution", traceStart);
   evolution.push_back(EvolutionEntry(iterationCount, Application::Ellapsed(), sol.cost));
+  if (improvement) improvement(sol, Application::Ellapsed());
 
   solBest = sol;
   double temperature;
   double tempStart = -0.05 * solBest.cost / std::log(0.5);
 
-  while ((iterationCount < param_MaxIt || Application::UsingTimeLimit()) && !Application::Timeout()) {
+  while ((iterationCount < param_MaxIt || Application::UsingTimeLimit() || Application::UsingWorkLimit()) &&
+         !Application::Timeout()) {
+    Trace::Span span("Iteration");
     iterationCount++;
 
     solPrime = sol;
@@ -127,10 +197,15 @@ void Solver::Solve() {
     removedRequests = RemoveRequests(instance, solPrime, q, param_P);
     ReinsertRequests(instance, solPrime, removedRequests, param_Fast);
 
+    // a work budget cools down like a time budget, but deterministically
     temperature = tempStart;
-    temperature *= Application::UsingTimeLimit()
-                       ? std::pow(param_C, param_MaxIt * Application::EllapsedRatio())
-                       : std::pow(param_C, static_cast<double>(iterationCount));
+    if (Application::UsingWorkLimit()) {
+      temperature *= std::pow(param_C, param_MaxIt * Work::Ratio());
+    } else {
+      temperature *= Application::UsingTimeLimit()
+                         ? std::pow(param_C, param_MaxIt * Application::EllapsedRatio())
+                         : std::pow(param_C, static_cast<double>(iterationCount));
+    }
 
     double acceptProbability = std::exp(-(solPrime.cost - sol.cost) / temperature);
 
@@ -141,6 +216,7 @@ void Solver::Solve() {
     if (solPrime < solBest) {
       solBest = solPrime;
       evolution.push_back(EvolutionEntry(iterationCount, Application::Ellapsed(), sol.cost));
+      if (improvement) improvement(solBest, Application::Ellapsed());
 
       if (Application::IsVerbose()) {
         std::cout << "New solution found: " << solBest.cost << "   IT: " << iterationCount << std::endl;
@@ -166,6 +242,8 @@ void Solver::PrintStats() {
     std::cout << "  \"version\": \"" << Application::Version() << "\"";
     std::cout << "," << std::endl << "  \"cost\": " << solBest.cost;
     std::cout << "," << std::endl << "  \"time\": " << Application::Ellapsed();
+    std::cout << "," << std::endl << "  \"work\": " << Work::Units();
+    std::cout << "," << std::endl << "  \"work_per_s\": " << Work::PerSecond(Application::Ellapsed());
     std::cout << "," << std::endl << "  \"educate\": " << iterationCount;
     std::cout << "," << std::endl << "  \"solution\": [0";
     for (int v = 1; v < solBest.visits.size(); v++) {
@@ -195,28 +273,4 @@ void Solver::PrintStats() {
   }
 }
 
-using namespace std;
-int main(int argc, char* argv[]) {
-  boost::program_options::variables_map variablesMap = Application::initializeVariablesMap(argc, argv);
-
-  uint seed = (uint)variablesMap["seed"].as<int>();
-  std::srand(seed);
-
-  if (variablesMap["instance"].empty())  // solve only one instance specified by
-                                         // the --instance cmdline argument
-  {
-    cout << "No input instance. Use --help for more information" << endl;
-    exit(1);
-  }
-
-  // Create solver
-  Solver solver(variablesMap);
-
-  // Run
-  solver.Solve();
-
-  // Print
-  solver.PrintStats();
-
-  return 0;
-}
+}  // namespace rr
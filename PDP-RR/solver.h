@@ -24,26 +24,27 @@ SOFTWARE.*/
 #define SOLVER_H
 
 #include <boost/program_options.hpp>
+#include <functional>
 #include <vector>
 
 #include "instance.h"
 
+namespace rr {
+
 class Solver {
   public:
     Solver(boost::program_options::variables_map& variablesMap);
+
+    //! Solver of an instance built in memory.
+    //! \param nodes: instance nodes (the solver takes their ownership), node 0 being the depot.
+    //! \param distances: distance matrix, or empty for the rounded Euclidean distances of the nodes.
+    Solver(boost::program_options::variables_map& variablesMap, const Instance::NodeList& nodes,
+           const std::vector<std::vector<double> >& distances);
     virtual ~Solver();
 
     void PrintStats();
     void Solve();
 
-  public:
-    const Instance instance;
-    double Ellapsed() const;
-
-  protected:
-    Solution solBest;
-
-  private:
     typedef struct _EvolutionEntry {
         size_t iteration;
         double time;
@@ -57,6 +58,37 @@ class Solver {
 
     } EvolutionEntry;
 
+    //! Get the best solution found.
+    const Solution& Best() const {
+      return solBest;
+    }
+
+    //! Get the improvements of the best solution.
+    const std::vector<EvolutionEntry>& Evolution() const {
+      return evolution;
+    }
+
+    //! Get the number of ruin and recreate iterations.
+    int Iterations() const {
+      return iterationCount;
+    }
+
+  public:
+    const Instance instance;
+    double Ellapsed() const;
+
+    //! Called with each new best solution and the time it was found.
+    std::function<void(const Solution&, double)> improvement;
+
+    //! Visit orders of the warm start (empty for the cheapest insertion start).
+    std::vector<std::vector<int> > initial;
+
+  protected:
+    Solution solBest;
+
+  private:
+    void LoadParameters(boost::program_options::variables_map& variablesMap);
+
     std::vector<EvolutionEntry> evolution;
 
     int qMin;
@@ -69,4 +101,6 @@ class Solver {
     bool param_Fast;
 };
 
+}  // namespace rr
+
 #endif  // SOLVER_H